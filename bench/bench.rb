@@ -0,0 +1,140 @@
+# Benchmarks for the binding's hot paths.
+#
+# Run with an mruby binary that has this gem linked in:
+#   mruby bench/bench.rb > bench_output.json
+#
+# Windows are created headless (null platform when GLFW 3.4 is available,
+# hidden windows otherwise), results are written to stdout as JSON.
+module GLFWBench
+  class Runner
+    attr_reader :results
+
+    def initialize
+      @results = []
+    end
+
+    # Runs the block +iterations+ times and records the rate.
+    def measure(name, iterations, unit = 'op')
+      yield 1 # warmup
+      t = GLFW.time
+      yield iterations
+      elapsed = GLFW.time - t
+      rate = elapsed > 0 ? iterations / elapsed : 0.0
+      @results << { 'name' => name, 'iterations' => iterations,
+                    'seconds' => elapsed, 'per_second' => rate, 'unit' => unit }
+    end
+
+    # Records how many objects a single call of the block leaves allocated,
+    # nil when ObjectSpace is unavailable.
+    def allocations(name)
+      count = nil
+      if Object.const_defined?(:ObjectSpace) && ObjectSpace.respond_to?(:count_objects)
+        GC.start
+        GC.disable
+        before = live_objects
+        yield
+        count = live_objects - before
+        GC.enable
+      end
+      @results << { 'name' => name, 'allocations' => count }
+    end
+
+    def to_json
+      '[' + @results.map { |r| hash_to_json(r) }.join(',') + ']'
+    end
+
+    private
+
+    def live_objects
+      counts = ObjectSpace.count_objects
+      counts[:TOTAL] - counts[:FREE]
+    end
+
+    def hash_to_json(hash)
+      '{' + hash.map { |k, v| "#{k.inspect}:#{value_to_json(v)}" }.join(',') + '}'
+    end
+
+    def value_to_json(value)
+      case value
+      when nil then 'null'
+      when String then value.inspect
+      else value.to_s
+      end
+    end
+  end
+
+  def self.init_headless
+    if GLFW.platform_supported?(:null)
+      GLFW.init(platform: :null)
+    else
+      GLFW.init(headless: true)
+    end
+  end
+
+  def self.callbacks(r, window)
+    n = 100_000
+    window.set_key_callback { |w, key, scancode, action, mods| }
+    window.set_char_callback { |w, codepoint| }
+    window.set_mouse_button_callback { |w, button, action, mods| }
+    window.set_cursor_pos_callback { |w, x, y| }
+    window.set_scroll_callback { |w, x, y| }
+    window.set_size_callback { |w, width, height| }
+    window.set_drop_callback { |w, paths| }
+
+    r.measure('callback.key', n, 'event') { |i| i.times { window.inject_key(GLFW::KEY_A, 0, GLFW::PRESS, 0) } }
+    r.measure('callback.char', n, 'event') { |i| i.times { window.inject_char(97) } }
+    r.measure('callback.mouse_button', n, 'event') { |i| i.times { window.inject_mouse_button(0, GLFW::PRESS, 0) } }
+    r.measure('callback.cursor_pos', n, 'event') { |i| i.times { window.inject_cursor_pos(1.0, 2.0) } }
+    r.measure('callback.scroll', n, 'event') { |i| i.times { window.inject_scroll(0.0, 1.0) } }
+    r.measure('callback.size', n, 'event') { |i| i.times { window.inject_size(640, 480) } }
+    paths = (0...64).map { |i| "/tmp/file#{i}.png" }
+    r.measure('callback.drop_64', n / 100, 'event') { |i| i.times { window.inject_drop(paths) } }
+
+    packed = GLFW::Window.pack_event(GLFW::Window::EVENT_CURSOR_POS, 1.0, 2.0) * 1000
+    r.measure('callback.inject_events.cursor_pos', n, 'event') { |i| (i / 1000).times { window.inject_events(packed) } }
+  end
+
+  def self.poll_events(r)
+    [1, 4, 16].each do |count|
+      windows = (0...count).map { |i| GLFW::Window.new(64, 64, "bench #{i}") }
+      r.measure("poll_events.windows_#{count}", 10_000, 'call') { |i| i.times { GLFW.poll_events } }
+      windows.each(&:destroy)
+    end
+  end
+
+  def self.accessors(r, window)
+    r.allocations('alloc.window_size') { window.window_size }
+    r.allocations('alloc.cursor_pos') { window.cursor_pos }
+    r.allocations('alloc.joystick_axes') { GLFW.joystick_axes(GLFW::JOYSTICK_1) }
+    r.measure('accessor.window_size', 100_000, 'call') { |i| i.times { window.window_size } }
+    r.measure('accessor.cursor_pos', 100_000, 'call') { |i| i.times { window.cursor_pos } }
+  end
+
+  def self.images(r)
+    image = GLFW::Image.new(256, 256)
+    pixel = [255, 128, 64, 255]
+    r.measure('image.clear_256', 10_000, 'image') { |i| i.times { image.clear(pixel) } }
+    r.measure('image.aset', 100_000, 'pixel') { |i| i.times { |j| image[j & 255, (j >> 8) & 255] = pixel } }
+    r.measure('image.aget', 100_000, 'pixel') { |i| i.times { |j| image[j & 255, (j >> 8) & 255] } }
+  end
+
+  def self.gamma_ramps(r)
+    r.measure('gamma_ramp.new_256', 100_000, 'object') { |i| i.times { GLFW::GammaRamp.new(256) } }
+  end
+
+  def self.run
+    init_headless
+    r = Runner.new
+    window = GLFW::Window.new(320, 240, 'bench')
+    callbacks(r, window)
+    accessors(r, window)
+    window.destroy
+    poll_events(r)
+    images(r)
+    gamma_ramps(r)
+    GLFW.terminate
+    puts r.to_json
+  end
+end
+
+GLFWBench.run
@@ -0,0 +1,60 @@
+/*
+ * Measures the cost of the gem's native initialization in isolation: a core
+ * VM is opened with and without mrb_mruby_glfw3_gem_init and the difference
+ * is reported. Prints JSON like bench/bench.rb.
+ *
+ * Build against the libmruby produced by a build config that includes this
+ * gem, e.g.
+ *   cc -O2 -Imruby/include bench/startup.c mruby/build/host/lib/libmruby.a \
+ *      -lglfw -lm -o glfw3_startup
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <mruby.h>
+
+void mrb_mruby_glfw3_gem_init(mrb_state *mrb);
+void mrb_mruby_glfw3_gem_final(mrb_state *mrb);
+
+static double
+now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double
+run(int iterations, int with_gem)
+{
+  double t = now();
+  int i;
+  for (i = 0; i < iterations; ++i) {
+    mrb_state *mrb = mrb_open_core(mrb_default_allocf, NULL);
+    if (!mrb) {
+      fprintf(stderr, "mrb_open_core failed\n");
+      exit(1);
+    }
+    if (with_gem) {
+      mrb_mruby_glfw3_gem_init(mrb);
+      mrb_mruby_glfw3_gem_final(mrb);
+    }
+    mrb_close(mrb);
+  }
+  return now() - t;
+}
+
+int
+main(int argc, char **argv)
+{
+  int iterations = argc > 1 ? atoi(argv[1]) : 200;
+  double base, with_gem;
+  run(1, 1); /* warmup */
+  base = run(iterations, 0);
+  with_gem = run(iterations, 1);
+  printf("[{\"name\": \"gem_init\", \"iterations\": %d, \"seconds\": %f, "
+         "\"base_seconds\": %f, \"usec_per_init\": %f}]\n",
+         iterations, with_gem, base, (with_gem - base) * 1e6 / iterations);
+  return 0;
+}
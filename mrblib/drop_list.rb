@@ -0,0 +1,26 @@
+module GLFW
+  class DropList
+    include Enumerable
+
+    alias :length :size
+
+    # Paths are only converted to Strings as they are yielded
+    def each
+      i = 0
+      while i < size
+        yield self[i]
+        i += 1
+      end
+      self
+    end
+
+    def empty?
+      size == 0
+    end
+
+    def inspect
+      str = super.dup
+      str.slice(0, str.size - 1) + " size=#{size}>"
+    end
+  end
+end
@@ -2,4 +2,14 @@ module GLFW
   def self.joystick_present?(id)
     joystick_present(id) == GL2::GL_TRUE
   end
+
+  # @return [Array<GLFW::Joystick>] the connected joysticks
+  def self.joysticks
+    mask = connected_joysticks
+    result = []
+    (JOYSTICK_1..JOYSTICK_LAST).each do |id|
+      result << Joystick.new(id) if (mask >> id) & 1 == 1
+    end
+    result
+  end
 end
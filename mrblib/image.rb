@@ -1,5 +1,7 @@
 module GLFW
   class Image
+    ICON_SIZES = [16, 32, 48, 256]
+
     def inspect
       str = super.dup
       str.slice(0, str.size - 1) + " pixelsize=#{pixelsize} memsize=#{memsize} width=#{width} height=#{height}>"
@@ -13,5 +15,11 @@ module GLFW
         clear_ary(*args)
       end
     end
+
+    # @return [Array<GLFW::Image>] this image scaled to each of +sizes+,
+    #   suitable for Window#icon=
+    def icon_set(sizes = ICON_SIZES)
+      sizes.map { |s| resize(s, s) }
+    end
   end
 end
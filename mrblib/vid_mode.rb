@@ -5,4 +5,30 @@ module GLFW
       str.slice(0, str.size - 1) + " width=#{width} height=#{height} red_bits=#{red_bits} green_bits=#{green_bits} blue_bits=#{blue_bits} refresh_rate=#{refresh_rate}>"
     end
   end
+
+  class VidModeList
+    include Enumerable
+
+    alias :length :size
+
+    # VidModes are only created as they are yielded
+    def each
+      i = 0
+      while i < size
+        yield self[i]
+        i += 1
+      end
+      self
+    end
+
+    def empty?
+      size == 0
+    end
+
+    def inspect
+      str = super.dup
+      return str unless valid?
+      str.slice(0, str.size - 1) + " size=#{size}>"
+    end
+  end
 end
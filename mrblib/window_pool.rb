@@ -0,0 +1,74 @@
+module GLFW
+  # Recycles hidden windows instead of destroying and recreating them,
+  # windows are pooled per HintSet (compared by identity).
+  class WindowPool
+    # @return [Integer] maximum number of idle windows kept per HintSet
+    attr_reader :capacity
+
+    def initialize(capacity = 4)
+      @capacity = capacity
+      @idle = {}
+      @hints = {}
+    end
+
+    # @param [GLFW::HintSet, nil] hints
+    # @return [GLFW::Window] a shown window of the requested size and title
+    def acquire(width, height, title, hints = nil)
+      window = take_idle(hints)
+      if window
+        window.window_size = [width, height]
+        window.title = title
+        window.show
+      elsif hints
+        window = Window.new(width, height, title, hints: hints)
+      else
+        window = Window.new(width, height, title)
+      end
+      @hints[window] = hints
+      window
+    end
+
+    # Hides the window and keeps it for reuse, the window is destroyed
+    # instead if the pool for its hints is full. Windows the pool did not
+    # hand out, or already took back, are ignored.
+    # @param [GLFW::Window] window
+    def release(window)
+      return unless @hints.key?(window)
+      hints = @hints.delete(window)
+      return if window.destroyed?
+      idle = (@idle[hints] ||= [])
+      if idle.size < @capacity
+        window.clear_callbacks
+        window.should_close = false
+        window.hide
+        idle << window
+      else
+        window.destroy
+      end
+      nil
+    end
+
+    # @return [Integer] number of idle windows
+    def size
+      @idle.values.inject(0) { |sum, idle| sum + idle.size }
+    end
+
+    # Destroys every idle window
+    def clear
+      @idle.each_value { |idle| idle.each { |window| window.destroy unless window.destroyed? } }
+      @idle.clear
+      self
+    end
+
+    private
+
+    def take_idle(hints)
+      idle = @idle[hints]
+      return nil unless idle
+      while (window = idle.pop)
+        return window unless window.destroyed?
+      end
+      nil
+    end
+  end
+end
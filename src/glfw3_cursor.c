@@ -1,3 +1,6 @@
+#include <stdint.h>
+#include <string.h>
+
 #include <mruby.h>
 #include <mruby/data.h>
 #include <mruby/array.h>
@@ -7,59 +10,226 @@
 
 #include "glfw3_cursor.h"
 #include "glfw3_image.h"
+#include "glfw3_private.h"
 #include "glfw3_window.h"
 
+#define NUM_OF_CHANNELS 4
+/* shape of cursors created from an image */
+#define CURSOR_IMAGE_SHAPE 0
+/* shape of cursors that were not created through this class */
+#define CURSOR_UNKNOWN_SHAPE -1
+
+/* Cursors are shared between Cursor objects: identical images (same size,
+ * pixels and hotspot) and identical standard shapes map to a single
+ * entry holding the GLFW handle. */
+typedef struct cursor_entry
+{
+  struct cursor_entry *next;
+  GLFWcursor *handle;
+  mrb_int refs;
+  uint64_t hash;
+  int shape;
+  int width;
+  int height;
+  int xhot;
+  int yhot;
+  unsigned char *pixels;
+} cursor_entry;
+
 static struct RClass *mrb_glfw3_cursor_class;
+static cursor_entry *cursor_registry = NULL;
+
+static uint64_t
+cursor_hash(const GLFWimage *image, int xhot, int yhot)
+{
+  /* FNV-1a */
+  uint64_t h = 14695981039346656037ULL;
+  const unsigned char *p = image->pixels;
+  size_t len = (size_t)image->width * image->height * NUM_OF_CHANNELS;
+  size_t i;
+  int header[4];
+  header[0] = image->width;
+  header[1] = image->height;
+  header[2] = xhot;
+  header[3] = yhot;
+  for (i = 0; i < sizeof(header); ++i) {
+    h = (h ^ ((const unsigned char*)header)[i]) * 1099511628211ULL;
+  }
+  for (i = 0; i < len; ++i) {
+    h = (h ^ p[i]) * 1099511628211ULL;
+  }
+  return h;
+}
+
+static void
+cursor_unlink(cursor_entry *entry)
+{
+  cursor_entry **it;
+  for (it = &cursor_registry; *it; it = &(*it)->next) {
+    if (*it == entry) {
+      *it = entry->next;
+      break;
+    }
+  }
+  entry->next = NULL;
+}
 
 void
 mrb_glfw_cursor_free(mrb_state *mrb, void *ptr)
 {
-  GLFWcursor *cursor = ptr;
-  if (cursor) {
-    glfwDestroyCursor(cursor);
+  cursor_entry *entry = ptr;
+  if (!entry || --entry->refs > 0) {
+    return;
+  }
+  cursor_unlink(entry);
+  if (entry->handle) {
+    glfwDestroyCursor(entry->handle);
+  }
+  if (entry->pixels) {
+    mrb_free(mrb, entry->pixels);
   }
+  mrb_free(mrb, entry);
 }
 
 const struct mrb_data_type mrb_glfw3_cursor_type = { "GLFWcursor", mrb_glfw_cursor_free };
 
-mrb_value
-mrb_glfw3_cursor_value(mrb_state *mrb, GLFWcursor *cursor)
+/* Forgets every cached handle, they are destroyed by glfwTerminate.
+ * Entries still referenced are released by their last Cursor object. */
+void
+mrb_glfw3_cursor_reset(mrb_state *mrb)
+{
+  cursor_entry *entry = cursor_registry;
+  while (entry) {
+    cursor_entry *next = entry->next;
+    entry->handle = NULL;
+    entry->next = NULL;
+    entry = next;
+  }
+  cursor_registry = NULL;
+}
+
+static cursor_entry*
+cursor_entry_new(mrb_state *mrb, GLFWcursor *handle, int shape)
+{
+  cursor_entry *entry;
+  if (!handle) {
+    mrb_raise(mrb, E_GLFW_ERROR, "Could not create cursor");
+  }
+  entry = mrb_calloc(mrb, 1, sizeof(cursor_entry));
+  entry->handle = handle;
+  entry->shape = shape;
+  entry->next = cursor_registry;
+  cursor_registry = entry;
+  return entry;
+}
+
+static mrb_value
+cursor_entry_value(mrb_state *mrb, cursor_entry *entry)
 {
   mrb_value result;
   result = mrb_obj_new(mrb, mrb_glfw3_cursor_class, 0, NULL);
-  DATA_PTR(result) = cursor;
+  DATA_PTR(result) = entry;
   DATA_TYPE(result) = &mrb_glfw3_cursor_type;
+  entry->refs++;
   return result;
 }
 
+mrb_value
+mrb_glfw3_cursor_value(mrb_state *mrb, GLFWcursor *cursor)
+{
+  cursor_entry *entry;
+  for (entry = cursor_registry; entry; entry = entry->next) {
+    if (entry->handle == cursor) {
+      return cursor_entry_value(mrb, entry);
+    }
+  }
+  return cursor_entry_value(mrb, cursor_entry_new(mrb, cursor, CURSOR_UNKNOWN_SHAPE));
+}
+
+/**
+ * Identical images with the same hotspot share one native cursor.
+ * @param [GLFW::Image] image
+ * @param [Integer] xhot
+ * @param [Integer] yhot
+ */
 static mrb_value
 cursor_s_create(mrb_state *mrb, mrb_value klass)
 {
   mrb_int xhot;
   mrb_int yhot;
   GLFWimage *image;
+  cursor_entry *entry;
+  uint64_t hash;
+  size_t size;
   mrb_get_args(mrb, "dii", &image, &mrb_glfw3_image_type, &xhot, &yhot);
-  return mrb_glfw3_cursor_value(mrb, glfwCreateCursor(image, xhot, yhot));
+  mrb_glfw3_ensure_init(mrb);
+  hash = cursor_hash(image, (int)xhot, (int)yhot);
+  size = (size_t)image->width * image->height * NUM_OF_CHANNELS;
+  for (entry = cursor_registry; entry; entry = entry->next) {
+    if (entry->shape == CURSOR_IMAGE_SHAPE && entry->hash == hash &&
+        entry->width == image->width && entry->height == image->height &&
+        entry->xhot == xhot && entry->yhot == yhot &&
+        memcmp(entry->pixels, image->pixels, size) == 0) {
+      return cursor_entry_value(mrb, entry);
+    }
+  }
+  entry = cursor_entry_new(mrb, glfwCreateCursor(image, xhot, yhot), CURSOR_IMAGE_SHAPE);
+  entry->hash = hash;
+  entry->width = image->width;
+  entry->height = image->height;
+  entry->xhot = (int)xhot;
+  entry->yhot = (int)yhot;
+  entry->pixels = mrb_malloc(mrb, size);
+  memcpy(entry->pixels, image->pixels, size);
+  return cursor_entry_value(mrb, entry);
 }
 
+/**
+ * Standard cursors are created once per shape.
+ * @param [Integer] shape
+ */
 static mrb_value
 cursor_s_create_standard(mrb_state *mrb, mrb_value klass)
 {
   mrb_int shape;
+  cursor_entry *entry;
   mrb_get_args(mrb, "i", &shape);
-  return mrb_glfw3_cursor_value(mrb, glfwCreateStandardCursor(shape));
+  mrb_glfw3_ensure_init(mrb);
+  /* the sentinel shapes belong to image and unknown cursors */
+  if (shape != CURSOR_IMAGE_SHAPE && shape != CURSOR_UNKNOWN_SHAPE) {
+    for (entry = cursor_registry; entry; entry = entry->next) {
+      if (entry->shape == shape) {
+        return cursor_entry_value(mrb, entry);
+      }
+    }
+  }
+  return cursor_entry_value(mrb, cursor_entry_new(mrb, glfwCreateStandardCursor(shape), shape));
 }
 
 static mrb_value
 cursor_s_set(mrb_state *mrb, mrb_value klass)
 {
-  GLFWwindow *window;
-  GLFWcursor *cursor;
+  mrb_glfw3_window *window;
+  cursor_entry *cursor;
   mrb_get_args(mrb, "dd", &window, &mrb_glfw3_window_type, &cursor, &mrb_glfw3_cursor_type);
-  glfwSetCursor(window, cursor);
+  glfwSetCursor(window->handle, cursor->handle);
   return klass;
 }
 
+/**
+ * @return [Integer] number of native cursors currently alive
+ */
+static mrb_value
+cursor_s_handle_count(mrb_state *mrb, mrb_value klass)
+{
+  mrb_int count = 0;
+  cursor_entry *entry;
+  for (entry = cursor_registry; entry; entry = entry->next) {
+    ++count;
+  }
+  return mrb_fixnum_value(count);
+}
+
 void
 mrb_glfw3_cursor_init(mrb_state *mrb, struct RClass *mod)
 {
@@ -69,4 +239,5 @@ mrb_glfw3_cursor_init(mrb_state *mrb, struct RClass *mod)
   mrb_define_class_method(mrb, mrb_glfw3_cursor_class, "create",          cursor_s_create,          MRB_ARGS_REQ(3));
   mrb_define_class_method(mrb, mrb_glfw3_cursor_class, "create_standard", cursor_s_create_standard, MRB_ARGS_REQ(1));
   mrb_define_class_method(mrb, mrb_glfw3_cursor_class, "set",             cursor_s_set,             MRB_ARGS_REQ(1));
+  mrb_define_class_method(mrb, mrb_glfw3_cursor_class, "handle_count",    cursor_s_handle_count,    MRB_ARGS_NONE());
 }
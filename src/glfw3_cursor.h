@@ -10,5 +10,6 @@
 extern const struct mrb_data_type mrb_glfw3_cursor_type;
 void mrb_glfw3_cursor_init(mrb_state *mrb, struct RClass *mod);
 mrb_value mrb_glfw3_cursor_value(mrb_state *mrb, GLFWcursor *cursor);
+void mrb_glfw3_cursor_reset(mrb_state *mrb);
 
 #endif
@@ -0,0 +1,167 @@
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <mruby.h>
+#include <mruby/data.h>
+#include <mruby/array.h>
+#include <mruby/string.h>
+
+#include "glfw3_drop_list.h"
+#include "glfw3_private.h"
+
+/* The path table and the path strings live in the same allocation as the
+ * header, so a list of any size costs a single mrb_malloc. */
+typedef struct drop_list
+{
+  mrb_int size;
+  const char **paths;
+} drop_list;
+
+static struct RClass *mrb_glfw3_drop_list_class;
+
+void
+mrb_glfw3_drop_list_free(mrb_state *mrb, void *ptr)
+{
+  if (ptr) {
+    mrb_free(mrb, ptr);
+  }
+}
+
+const struct mrb_data_type mrb_glfw3_drop_list_type = { "GLFWdroplist", mrb_glfw3_drop_list_free };
+
+static inline drop_list*
+get_drop_list(mrb_state *mrb, mrb_value self)
+{
+  return (drop_list*)mrb_data_get_ptr(mrb, self, &mrb_glfw3_drop_list_type);
+}
+
+/* Copies the paths for which keep[i] is true (or all if keep is NULL) */
+static drop_list*
+drop_list_new(mrb_state *mrb, mrb_int count, const char **paths, const bool *keep)
+{
+  drop_list *list;
+  char *strs;
+  size_t bytes = 0;
+  mrb_int size = 0;
+  mrb_int i;
+  for (i = 0; i < count; ++i) {
+    if (!keep || keep[i]) {
+      bytes += strlen(paths[i]) + 1;
+      ++size;
+    }
+  }
+  list = mrb_malloc(mrb, sizeof(drop_list) + sizeof(char*) * size + bytes);
+  list->size = size;
+  list->paths = (const char**)(list + 1);
+  strs = (char*)(list->paths + size);
+  size = 0;
+  for (i = 0; i < count; ++i) {
+    if (!keep || keep[i]) {
+      size_t len = strlen(paths[i]) + 1;
+      memcpy(strs, paths[i], len);
+      list->paths[size++] = strs;
+      strs += len;
+    }
+  }
+  return list;
+}
+
+mrb_value
+mrb_glfw3_drop_list_value(mrb_state *mrb, int count, const char **paths)
+{
+  mrb_value result = mrb_obj_new(mrb, mrb_glfw3_drop_list_class, 0, NULL);
+  DATA_PTR(result) = drop_list_new(mrb, count, paths, NULL);
+  DATA_TYPE(result) = &mrb_glfw3_drop_list_type;
+  return result;
+}
+
+static mrb_value
+drop_list_size(mrb_state *mrb, mrb_value self)
+{
+  return mrb_fixnum_value(get_drop_list(mrb, self)->size);
+}
+
+static mrb_value
+drop_list_aget(mrb_state *mrb, mrb_value self)
+{
+  drop_list *list;
+  mrb_int index;
+  mrb_get_args(mrb, "i", &index);
+  list = get_drop_list(mrb, self);
+  if (index < 0) {
+    index += list->size;
+  }
+  if (index < 0 || index >= list->size) {
+    return mrb_nil_value();
+  }
+  return mrb_str_new_cstr(mrb, list->paths[index]);
+}
+
+static bool
+path_has_extension(const char *path, const char *ext, size_t ext_len)
+{
+  size_t len = strlen(path);
+  size_t i;
+  if (len <= ext_len || path[len - ext_len - 1] != '.') {
+    return false;
+  }
+  path += len - ext_len;
+  for (i = 0; i < ext_len; ++i) {
+    if (tolower((unsigned char)path[i]) != tolower((unsigned char)ext[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @param [String] exts extensions to keep, with or without the leading dot,
+ *                      compared case insensitively
+ * @return [GLFW::DropList] a new list of the matching paths
+ */
+static mrb_value
+drop_list_filter_extensions(mrb_state *mrb, mrb_value self)
+{
+  drop_list *list;
+  mrb_value *exts;
+  mrb_int extc;
+  mrb_value buf;
+  mrb_value result;
+  bool *keep;
+  mrb_int i;
+  mrb_int j;
+  mrb_get_args(mrb, "*", &exts, &extc);
+  list = get_drop_list(mrb, self);
+  /* backed by a String so it is collected if a conversion raises */
+  buf = mrb_str_buf_new(mrb, sizeof(bool) * (list->size + 1));
+  keep = (bool*)RSTRING_PTR(buf);
+  memset(keep, 0, sizeof(bool) * list->size);
+  for (j = 0; j < extc; ++j) {
+    const char *ext = mrb_string_value_cstr(mrb, &exts[j]);
+    size_t ext_len;
+    if (ext[0] == '.') {
+      ++ext;
+    }
+    ext_len = strlen(ext);
+    for (i = 0; i < list->size; ++i) {
+      if (!keep[i] && path_has_extension(list->paths[i], ext, ext_len)) {
+        keep[i] = true;
+      }
+    }
+  }
+  result = mrb_obj_new(mrb, mrb_glfw3_drop_list_class, 0, NULL);
+  DATA_PTR(result) = drop_list_new(mrb, list->size, list->paths, keep);
+  DATA_TYPE(result) = &mrb_glfw3_drop_list_type;
+  return result;
+}
+
+void
+mrb_glfw3_drop_list_init(mrb_state *mrb, struct RClass *mod)
+{
+  mrb_glfw3_drop_list_class = mrb_define_class_under(mrb, mod, "DropList", mrb->object_class);
+  MRB_SET_INSTANCE_TT(mrb_glfw3_drop_list_class, MRB_TT_DATA);
+  mrb_define_method(mrb, mrb_glfw3_drop_list_class, "size",              drop_list_size,              MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_glfw3_drop_list_class, "[]",                drop_list_aget,              MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, mrb_glfw3_drop_list_class, "filter_extensions", drop_list_filter_extensions, MRB_ARGS_ANY());
+}
@@ -0,0 +1,12 @@
+#ifndef MRB_GLFW3_DROP_LIST_H
+#define MRB_GLFW3_DROP_LIST_H
+
+#include <mruby.h>
+#include <mruby/data.h>
+#include <mruby/class.h>
+
+extern const struct mrb_data_type mrb_glfw3_drop_list_type;
+void mrb_glfw3_drop_list_init(mrb_state *mrb, struct RClass *mod);
+mrb_value mrb_glfw3_drop_list_value(mrb_state *mrb, int count, const char **paths);
+
+#endif
@@ -0,0 +1,130 @@
+#include <stdbool.h>
+
+#include <mruby.h>
+#include <mruby/array.h>
+#include <mruby/hash.h>
+#include <mruby/string.h>
+#include <mruby/variable.h>
+
+#include "glfw3_extensions.h"
+#include "glfw3_private.h"
+
+#define BITS_PER_WORD (sizeof(unsigned int) * 8)
+
+/* Bumped by GLFW.track_extensions, windows built for an older generation
+ * rebuild their bits on the next query. */
+static int extensions_generation = 1;
+
+static mrb_value
+extensions_names(mrb_state *mrb)
+{
+  return mrb_iv_get(mrb, mrb_obj_value(mrb_module_get(mrb, "GLFW")), mrb_intern_lit(mrb, "__extension_names"));
+}
+
+static mrb_value
+extensions_ids(mrb_state *mrb)
+{
+  return mrb_iv_get(mrb, mrb_obj_value(mrb_module_get(mrb, "GLFW")), mrb_intern_lit(mrb, "__extension_ids"));
+}
+
+void
+mrb_glfw3_extensions_update(mrb_state *mrb, mrb_glfw3_window *window)
+{
+  mrb_value names;
+  mrb_int count;
+  mrb_int i;
+  if (window->extensions.generation == extensions_generation) {
+    return;
+  }
+  names = extensions_names(mrb);
+  count = mrb_nil_p(names) ? 0 : RARRAY_LEN(names);
+  if (glfwGetWindowAttrib(window->handle, GLFW_CLIENT_API) == GLFW_NO_API) {
+    /* no context, nothing is supported */
+    count = 0;
+  }
+  window->extensions.bits = mrb_realloc(mrb, window->extensions.bits,
+    sizeof(unsigned int) * (count / BITS_PER_WORD + 1));
+  memset(window->extensions.bits, 0, sizeof(unsigned int) * (count / BITS_PER_WORD + 1));
+  for (i = 0; i < count; ++i) {
+    if (glfwExtensionSupported(RSTRING_PTR(RARRAY_PTR(names)[i]))) {
+      window->extensions.bits[i / BITS_PER_WORD] |= 1u << (i % BITS_PER_WORD);
+    }
+  }
+  window->extensions.count = count;
+  window->extensions.generation = extensions_generation;
+}
+
+/**
+ * Sets the extensions cached per context, each is given the id of its
+ * index and can also be queried by Symbol.
+ * @param [Array<String>] names
+ * @return [Hash<Symbol, Integer>] name to id
+ */
+static mrb_value
+glfw_s_track_extensions(mrb_state *mrb, mrb_value klass)
+{
+  mrb_value *names;
+  mrb_int count;
+  mrb_int i;
+  mrb_value copy;
+  mrb_value ids;
+  mrb_get_args(mrb, "a", &names, &count);
+  copy = mrb_ary_new_capa(mrb, count);
+  ids = mrb_hash_new(mrb);
+  for (i = 0; i < count; ++i) {
+    mrb_value name = mrb_str_dup(mrb, mrb_string_type(mrb, names[i]));
+    mrb_ary_push(mrb, copy, name);
+    mrb_hash_set(mrb, ids, mrb_symbol_value(mrb_intern_str(mrb, name)), mrb_fixnum_value(i));
+  }
+  mrb_iv_set(mrb, klass, mrb_intern_lit(mrb, "__extension_names"), copy);
+  mrb_iv_set(mrb, klass, mrb_intern_lit(mrb, "__extension_ids"), ids);
+  ++extensions_generation;
+  return ids;
+}
+
+/**
+ * @param [String, Symbol, Integer] ext a String is always checked with
+ *   glfwExtensionSupported, Symbols and ids must have been tracked and are
+ *   answered from the current context's cache.
+ * @return [Boolean]
+ */
+static mrb_value
+glfw_s_extension_supported_p(mrb_state *mrb, mrb_value klass)
+{
+  mrb_value ext;
+  mrb_value id;
+  mrb_int index;
+  GLFWwindow *context;
+  mrb_glfw3_window *window;
+  mrb_get_args(mrb, "o", &ext);
+  if (mrb_string_p(ext)) {
+    return mrb_bool_value(glfwExtensionSupported(mrb_string_value_cstr(mrb, &ext)) != GL_FALSE);
+  }
+  if (mrb_symbol_p(ext)) {
+    mrb_value ids = extensions_ids(mrb);
+    id = mrb_nil_p(ids) ? mrb_nil_value() : mrb_hash_get(mrb, ids, ext);
+    if (mrb_nil_p(id)) {
+      mrb_raisef(mrb, E_ARGUMENT_ERROR, "extension %S is not tracked", ext);
+    }
+  } else {
+    id = mrb_to_int(mrb, ext);
+  }
+  context = glfwGetCurrentContext();
+  if (!context) {
+    mrb_raise(mrb, E_GLFW_ERROR, "No current context to query extensions of.");
+  }
+  window = mrb_glfw3_window_data(context);
+  mrb_glfw3_extensions_update(mrb, window);
+  index = mrb_fixnum(id);
+  if (index < 0 || index >= window->extensions.count) {
+    return mrb_false_value();
+  }
+  return mrb_bool_value((window->extensions.bits[index / BITS_PER_WORD] >> (index % BITS_PER_WORD)) & 1);
+}
+
+void
+mrb_glfw3_extensions_init(mrb_state *mrb, struct RClass *mod)
+{
+  mrb_define_class_method(mrb, mod, "track_extensions",     glfw_s_track_extensions,     MRB_ARGS_REQ(1));
+  mrb_define_class_method(mrb, mod, "extension_supported?", glfw_s_extension_supported_p, MRB_ARGS_REQ(1));
+}
@@ -0,0 +1,14 @@
+#ifndef MRB_GLFW3_EXTENSIONS_H
+#define MRB_GLFW3_EXTENSIONS_H
+
+#include <mruby.h>
+#include <mruby/class.h>
+
+#include "glfw3_window.h"
+
+void mrb_glfw3_extensions_init(mrb_state *mrb, struct RClass *mod);
+/* Rebuilds the window's support bits if they are stale, the window's
+ * context must be current */
+void mrb_glfw3_extensions_update(mrb_state *mrb, mrb_glfw3_window *window);
+
+#endif
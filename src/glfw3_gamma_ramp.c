@@ -10,24 +10,12 @@
 
 static struct RClass *mrb_glfw3_gamma_ramp_class;
 
+/* A ramp and its three channels live in one block, freed at once */
 void
 mrb_glfw3_gamma_ramp_free(mrb_state *mrb, void *vptr)
 {
-  GLFWgammaramp *ptr = vptr;
-  if (ptr) {
-    if (ptr->red) {
-      mrb_free(mrb, ptr->red);
-      ptr->red = NULL;
-    }
-    if (ptr->green) {
-      mrb_free(mrb, ptr->green);
-      ptr->green = NULL;
-    }
-    if (ptr->blue) {
-      mrb_free(mrb, ptr->blue);
-      ptr->blue = NULL;
-    }
-    mrb_free(mrb, ptr);
+  if (vptr) {
+    mrb_free(mrb, vptr);
   }
 }
 
@@ -39,23 +27,28 @@ get_gamma_ramp(mrb_state *mrb, mrb_value self)
   return (GLFWgammaramp*)mrb_data_get_ptr(mrb, self, &mrb_glfw3_gamma_ramp_type);
 }
 
+static GLFWgammaramp*
+gamma_ramp_alloc(mrb_state *mrb, unsigned int size)
+{
+  GLFWgammaramp *gammaramp;
+  unsigned short *channels;
+  gammaramp = mrb_malloc(mrb, sizeof(GLFWgammaramp) + sizeof(unsigned short) * size * 3);
+  channels = (unsigned short*)(gammaramp + 1);
+  gammaramp->size = size;
+  gammaramp->red = channels;
+  gammaramp->green = channels + size;
+  gammaramp->blue = channels + size * 2;
+  return gammaramp;
+}
+
 mrb_value
 mrb_glfw3_gamma_ramp_value(mrb_state *mrb, const GLFWgammaramp *gramp)
 {
-  GLFWgammaramp *gammaramp;
-  mrb_value result;
-  result = mrb_obj_new(mrb, mrb_glfw3_gamma_ramp_class, 0, NULL);
-  gammaramp = mrb_malloc(mrb, sizeof(GLFWgammaramp));
-  gammaramp->size = gramp->size;
-  gammaramp->red = mrb_malloc(mrb, sizeof(short) * gammaramp->size);
-  gammaramp->green = mrb_malloc(mrb, sizeof(short) * gammaramp->size);
-  gammaramp->blue = mrb_malloc(mrb, sizeof(short) * gammaramp->size);
-  memcpy(gammaramp->red, gramp->red, sizeof(short) * gammaramp->size);
-  memcpy(gammaramp->green, gramp->green, sizeof(short) * gammaramp->size);
-  memcpy(gammaramp->blue, gramp->blue, sizeof(short) * gammaramp->size);
-  DATA_PTR(result) = gammaramp;
-  DATA_TYPE(result) = &mrb_glfw3_gamma_ramp_type;
-  return result;
+  GLFWgammaramp *gammaramp = gamma_ramp_alloc(mrb, gramp->size);
+  memcpy(gammaramp->red, gramp->red, sizeof(unsigned short) * gammaramp->size);
+  memcpy(gammaramp->green, gramp->green, sizeof(unsigned short) * gammaramp->size);
+  memcpy(gammaramp->blue, gramp->blue, sizeof(unsigned short) * gammaramp->size);
+  return mrb_obj_value(mrb_data_object_alloc(mrb, mrb_glfw3_gamma_ramp_class, gammaramp, &mrb_glfw3_gamma_ramp_type));
 }
 
 static mrb_value
@@ -66,14 +59,8 @@ gamma_ramp_initialize(mrb_state *mrb, mrb_value self)
   mrb_get_args(mrb, "|i", &size);
 
   if (size != 0) {
-    gammaramp = mrb_malloc(mrb, sizeof(GLFWgammaramp));
-    gammaramp->size = size;
-    gammaramp->red = mrb_malloc(mrb, sizeof(short) * gammaramp->size);
-    gammaramp->green = mrb_malloc(mrb, sizeof(short) * gammaramp->size);
-    gammaramp->blue = mrb_malloc(mrb, sizeof(short) * gammaramp->size);
-    memset(gammaramp->red, 0, sizeof(short) * gammaramp->size);
-    memset(gammaramp->green, 0, sizeof(short) * gammaramp->size);
-    memset(gammaramp->blue, 0, sizeof(short) * gammaramp->size);
+    gammaramp = gamma_ramp_alloc(mrb, size);
+    memset(gammaramp->red, 0, sizeof(unsigned short) * gammaramp->size * 3);
     DATA_PTR(self) = gammaramp;
     DATA_TYPE(self) = &mrb_glfw3_gamma_ramp_type;
   }
@@ -88,7 +75,7 @@ gamma_ramp_get_row(mrb_state *mrb, mrb_value self)
   mrb_int row;
   mrb_get_args(mrb, "i", &row);
   gammaramp = get_gamma_ramp(mrb, self);
-  if (row < 0 || row > (int)gammaramp->size) {
+  if (row < 0 || row >= (int)gammaramp->size) {
     mrb_raise(mrb, E_INDEX_ERROR, "row is out of range!");
     return mrb_nil_value();
   }
@@ -108,7 +95,7 @@ gamma_ramp_set_row(mrb_state *mrb, mrb_value self)
   mrb_int b;
   mrb_get_args(mrb, "iiii", &row, &r, &g, &b);
   gammaramp = get_gamma_ramp(mrb, self);
-  if (row < 0 || row > (int)gammaramp->size) {
+  if (row < 0 || row >= (int)gammaramp->size) {
     mrb_raise(mrb, E_INDEX_ERROR, "row is out of range!");
     return mrb_nil_value();
   }
@@ -0,0 +1,173 @@
+#include <stdbool.h>
+
+#include <mruby.h>
+#include <mruby/data.h>
+#include <mruby/array.h>
+#include <mruby/hash.h>
+
+#include <GLFW/glfw3.h>
+
+#include "glfw3_hint_set.h"
+#include "glfw3_private.h"
+
+typedef struct hint_pair
+{
+  int hint;
+  int value;
+} hint_pair;
+
+typedef struct hint_set
+{
+  mrb_int size;
+  mrb_int capa;
+  hint_pair *pairs;
+} hint_set;
+
+static struct RClass *mrb_glfw3_hint_set_class;
+
+void
+mrb_glfw3_hint_set_free(mrb_state *mrb, void *ptr)
+{
+  hint_set *set = ptr;
+  if (set) {
+    if (set->pairs) {
+      mrb_free(mrb, set->pairs);
+    }
+    mrb_free(mrb, set);
+  }
+}
+
+const struct mrb_data_type mrb_glfw3_hint_set_type = { "GLFWhintset", mrb_glfw3_hint_set_free };
+
+static inline hint_set*
+get_hint_set(mrb_state *mrb, mrb_value self)
+{
+  return (hint_set*)mrb_data_get_ptr(mrb, self, &mrb_glfw3_hint_set_type);
+}
+
+static hint_pair*
+hint_set_find(hint_set *set, int hint)
+{
+  mrb_int i;
+  for (i = 0; i < set->size; ++i) {
+    if (set->pairs[i].hint == hint) {
+      return &set->pairs[i];
+    }
+  }
+  return NULL;
+}
+
+static void
+hint_set_put(mrb_state *mrb, hint_set *set, int hint, int value)
+{
+  hint_pair *pair = hint_set_find(set, hint);
+  if (!pair) {
+    if (set->size == set->capa) {
+      set->capa = set->capa ? set->capa * 2 : 8;
+      set->pairs = mrb_realloc(mrb, set->pairs, sizeof(hint_pair) * set->capa);
+    }
+    pair = &set->pairs[set->size++];
+    pair->hint = hint;
+  }
+  pair->value = value;
+}
+
+void
+mrb_glfw3_hint_set_apply(mrb_state *mrb, mrb_value self)
+{
+  hint_set *set = mrb_data_check_get_ptr(mrb, self, &mrb_glfw3_hint_set_type);
+  mrb_int i;
+  if (!set) {
+    mrb_raise(mrb, E_TYPE_ERROR, "expected GLFW::HintSet");
+  }
+  mrb_glfw3_ensure_init(mrb);
+  mrb_glfw3_default_window_hints();
+  for (i = 0; i < set->size; ++i) {
+    glfwWindowHint(set->pairs[i].hint, set->pairs[i].value);
+  }
+}
+
+/**
+ * @param [Hash<Integer, Integer>] hints optional initial hint => value pairs
+ */
+static mrb_value
+hint_set_initialize(mrb_state *mrb, mrb_value self)
+{
+  hint_set *set;
+  mrb_value hash = mrb_nil_value();
+  mrb_get_args(mrb, "|H", &hash);
+  set = mrb_calloc(mrb, 1, sizeof(hint_set));
+  mrb_data_init(self, set, &mrb_glfw3_hint_set_type);
+  if (!mrb_nil_p(hash)) {
+    mrb_value keys = mrb_hash_keys(mrb, hash);
+    mrb_int i;
+    for (i = 0; i < RARRAY_LEN(keys); ++i) {
+      mrb_value key = RARRAY_PTR(keys)[i];
+      hint_set_put(mrb, set, (int)mrb_int(mrb, key), (int)mrb_int(mrb, mrb_hash_get(mrb, hash, key)));
+    }
+  }
+  return self;
+}
+
+static mrb_value
+hint_set_aset(mrb_state *mrb, mrb_value self)
+{
+  mrb_int hint, value;
+  mrb_get_args(mrb, "ii", &hint, &value);
+  hint_set_put(mrb, get_hint_set(mrb, self), (int)hint, (int)value);
+  return mrb_fixnum_value(value);
+}
+
+static mrb_value
+hint_set_aget(mrb_state *mrb, mrb_value self)
+{
+  mrb_int hint;
+  hint_pair *pair;
+  mrb_get_args(mrb, "i", &hint);
+  pair = hint_set_find(get_hint_set(mrb, self), (int)hint);
+  return pair ? mrb_fixnum_value(pair->value) : mrb_nil_value();
+}
+
+static mrb_value
+hint_set_delete(mrb_state *mrb, mrb_value self)
+{
+  mrb_int hint;
+  hint_set *set;
+  hint_pair *pair;
+  int value;
+  mrb_get_args(mrb, "i", &hint);
+  set = get_hint_set(mrb, self);
+  pair = hint_set_find(set, (int)hint);
+  if (!pair) {
+    return mrb_nil_value();
+  }
+  value = pair->value;
+  *pair = set->pairs[--set->size];
+  return mrb_fixnum_value(value);
+}
+
+static mrb_value
+hint_set_size(mrb_state *mrb, mrb_value self)
+{
+  return mrb_fixnum_value(get_hint_set(mrb, self)->size);
+}
+
+static mrb_value
+hint_set_apply(mrb_state *mrb, mrb_value self)
+{
+  mrb_glfw3_hint_set_apply(mrb, self);
+  return self;
+}
+
+void
+mrb_glfw3_hint_set_init(mrb_state *mrb, struct RClass *mod)
+{
+  mrb_glfw3_hint_set_class = mrb_define_class_under(mrb, mod, "HintSet", mrb->object_class);
+  MRB_SET_INSTANCE_TT(mrb_glfw3_hint_set_class, MRB_TT_DATA);
+  mrb_define_method(mrb, mrb_glfw3_hint_set_class, "initialize", hint_set_initialize, MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, mrb_glfw3_hint_set_class, "[]=",        hint_set_aset,       MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, mrb_glfw3_hint_set_class, "[]",         hint_set_aget,       MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, mrb_glfw3_hint_set_class, "delete",     hint_set_delete,     MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, mrb_glfw3_hint_set_class, "size",       hint_set_size,       MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_glfw3_hint_set_class, "apply",      hint_set_apply,      MRB_ARGS_NONE());
+}
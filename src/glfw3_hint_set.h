@@ -0,0 +1,13 @@
+#ifndef MRB_GLFW3_HINT_SET_H
+#define MRB_GLFW3_HINT_SET_H
+
+#include <mruby.h>
+#include <mruby/data.h>
+#include <mruby/class.h>
+
+extern const struct mrb_data_type mrb_glfw3_hint_set_type;
+void mrb_glfw3_hint_set_init(mrb_state *mrb, struct RClass *mod);
+/* Resets the window hints to their defaults and applies the set */
+void mrb_glfw3_hint_set_apply(mrb_state *mrb, mrb_value set);
+
+#endif
@@ -1,10 +1,16 @@
+#include <limits.h>
+#include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 
 #include <mruby.h>
 #include <mruby/data.h>
+#include <mruby/error.h>
 #include <mruby/array.h>
 #include <mruby/numeric.h>
+#include <mruby/string.h>
 
 #include <GLFW/glfw3.h>
 #include "glfw3_image.h"
@@ -12,6 +18,19 @@
 
 #define NUM_OF_CHANNELS 4
 
+/* Image file layout, all integers little endian:
+ *   "GLFI" u8 version, u8 format, u8 compression, u8 reserved,
+ *   u32 width, u32 height, then the pixel payload. */
+#define IMAGE_FILE_MAGIC "GLFI"
+#define IMAGE_FILE_VERSION 1
+#define IMAGE_FILE_HEADER_SIZE 16
+#define IMAGE_FORMAT_RGBA8 0
+#define IMAGE_COMPRESSION_NONE 0
+/* runs of pixels: u8 n, n & 0x80 repeats the next pixel (n & 0x7F) + 1
+ * times, otherwise n + 1 literal pixels follow */
+#define IMAGE_COMPRESSION_RLE 1
+#define IMAGE_RLE_MAX_RUN 128
+
 typedef struct pixel_
 {
   union {
@@ -173,6 +192,372 @@ image_aset(mrb_state *mrb, mrb_value self)
   return mrb_nil_value();
 }
 
+/* Box filter: each destination pixel averages the source pixels it
+ * covers, degrading to nearest neighbour when upscaling. */
+static void
+image_box_resize(const GLFWimage *src, GLFWimage *dst)
+{
+  const pixel_t *sp = image_pixels((GLFWimage*)src);
+  pixel_t *dp = image_pixels(dst);
+  int x, y, sx, sy;
+  for (y = 0; y < dst->height; ++y) {
+    int y0 = (int)((long long)y * src->height / dst->height);
+    int y1 = (int)((long long)(y + 1) * src->height / dst->height);
+    if (y1 <= y0) {
+      y1 = y0 + 1;
+    }
+    for (x = 0; x < dst->width; ++x) {
+      int x0 = (int)((long long)x * src->width / dst->width);
+      int x1 = (int)((long long)(x + 1) * src->width / dst->width);
+      unsigned int r = 0, g = 0, b = 0, a = 0;
+      unsigned int n;
+      pixel_t *out = &dp[x + y * dst->width];
+      if (x1 <= x0) {
+        x1 = x0 + 1;
+      }
+      n = (unsigned int)((x1 - x0) * (y1 - y0));
+      for (sy = y0; sy < y1; ++sy) {
+        const pixel_t *row = &sp[sy * src->width];
+        for (sx = x0; sx < x1; ++sx) {
+          r += row[sx].r;
+          g += row[sx].g;
+          b += row[sx].b;
+          a += row[sx].a;
+        }
+      }
+      out->r = (unsigned char)((r + n / 2) / n);
+      out->g = (unsigned char)((g + n / 2) / n);
+      out->b = (unsigned char)((b + n / 2) / n);
+      out->a = (unsigned char)((a + n / 2) / n);
+    }
+  }
+}
+
+/**
+ * @param [Integer] w
+ * @param [Integer] h
+ * @return [GLFW::Image] a new image scaled to w x h
+ */
+static mrb_value
+image_resize(mrb_state *mrb, mrb_value self)
+{
+  GLFWimage *src = get_image(mrb, self);
+  mrb_int w;
+  mrb_int h;
+  mrb_value argv[2];
+  mrb_value result;
+  mrb_get_args(mrb, "ii", &w, &h);
+  argv[0] = mrb_fixnum_value(w);
+  argv[1] = mrb_fixnum_value(h);
+  result = mrb_obj_new(mrb, mrb_glfw3_image_class, 2, argv);
+  if (src->width > 0 && src->height > 0) {
+    image_box_resize(src, get_image(mrb, result));
+  }
+  return result;
+}
+
+/* Writes the absolute channel deltas of one pixel to ad, adds their
+ * squares to sq and returns the largest one */
+static inline unsigned int
+diff_pixel(const unsigned char *a, const unsigned char *b, unsigned char *ad, uint64_t *sq)
+{
+  unsigned int pixel_max = 0;
+  int c;
+  for (c = 0; c < NUM_OF_CHANNELS; ++c) {
+    int delta = (int)a[c] - (int)b[c];
+    unsigned int v = (unsigned int)(delta < 0 ? -delta : delta);
+    ad[c] = (unsigned char)v;
+    *sq += v * v;
+    pixel_max = v > pixel_max ? v : pixel_max;
+  }
+  return pixel_max;
+}
+
+/**
+ * @param [GLFW::Image] other image of the same size
+ * @param [Integer] tolerance largest channel delta still considered equal
+ * @param [GLFW::Image] diff_image optional image of the same size receiving
+ *   the per channel absolute deltas
+ * @return [Array] mismatched pixel count, max channel delta and PSNR in dB
+ *   (Infinity when identical)
+ */
+static mrb_value
+image_diff(mrb_state *mrb, mrb_value self)
+{
+  GLFWimage *image = get_image(mrb, self);
+  GLFWimage *other;
+  GLFWimage *out = NULL;
+  mrb_value out_obj = mrb_nil_value();
+  mrb_int tolerance = 0;
+  const unsigned char *a;
+  const unsigned char *b;
+  unsigned char *d;
+  size_t len, i;
+  uint64_t sq = 0;
+  mrb_int mismatched = 0;
+  unsigned int max_delta = 0;
+  mrb_value vals[3];
+  mrb_get_args(mrb, "d|io", &other, &mrb_glfw3_image_type, &tolerance, &out_obj);
+  if (tolerance < 0) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "tolerance must not be negative");
+  }
+  if (image->width != other->width || image->height != other->height) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Image dimensions differ");
+  }
+  if (!mrb_nil_p(out_obj)) {
+    out = mrb_data_get_ptr(mrb, out_obj, &mrb_glfw3_image_type);
+    if (!out || out->width != image->width || out->height != image->height) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "diff image must be an Image of the same size");
+    }
+  }
+  a = image->pixels;
+  b = other->pixels;
+  d = out ? out->pixels : NULL;
+  len = (size_t)calc_image_size(image);
+  /* the diff image check stays outside the loops so the channel loop
+   * remains flat for the vectorizer */
+  if (d) {
+    for (i = 0; i < len; ++i) {
+      size_t o = i * NUM_OF_CHANNELS;
+      unsigned int pixel_max = diff_pixel(a + o, b + o, d + o, &sq);
+      mismatched += pixel_max > (unsigned int)tolerance;
+      max_delta = pixel_max > max_delta ? pixel_max : max_delta;
+    }
+  } else {
+    unsigned char scratch[NUM_OF_CHANNELS];
+    for (i = 0; i < len; ++i) {
+      size_t o = i * NUM_OF_CHANNELS;
+      unsigned int pixel_max = diff_pixel(a + o, b + o, scratch, &sq);
+      mismatched += pixel_max > (unsigned int)tolerance;
+      max_delta = pixel_max > max_delta ? pixel_max : max_delta;
+    }
+  }
+  vals[0] = mrb_fixnum_value(mismatched);
+  vals[1] = mrb_fixnum_value(max_delta);
+  if (sq == 0) {
+    vals[2] = mrb_float_value(mrb, INFINITY);
+  } else {
+    double mse = (double)sq / ((double)len * NUM_OF_CHANNELS);
+    vals[2] = mrb_float_value(mrb, 10.0 * log10(255.0 * 255.0 / mse));
+  }
+  return mrb_ary_new_from_values(mrb, 3, vals);
+}
+
+static void
+put_u32(unsigned char *p, uint32_t v)
+{
+  p[0] = v & 0xFF;
+  p[1] = (v >> 8) & 0xFF;
+  p[2] = (v >> 16) & 0xFF;
+  p[3] = (v >> 24) & 0xFF;
+}
+
+static uint32_t
+get_u32(const unsigned char *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool
+image_write_rle(FILE *fp, GLFWimage *image)
+{
+  const pixel_t *pixels = image_pixels(image);
+  int len = calc_image_size(image);
+  int i = 0;
+  while (i < len) {
+    unsigned char n;
+    int run = 1;
+    while (i + run < len && run < IMAGE_RLE_MAX_RUN && pixels[i + run].val == pixels[i].val) {
+      ++run;
+    }
+    if (run > 1) {
+      n = 0x80 | (run - 1);
+      if (fwrite(&n, 1, 1, fp) != 1 || fwrite(&pixels[i], sizeof(pixel_t), 1, fp) != 1) {
+        return false;
+      }
+    } else {
+      /* literal span ends where a repeat starts */
+      while (i + run < len && run < IMAGE_RLE_MAX_RUN &&
+             (i + run + 1 >= len || pixels[i + run].val != pixels[i + run + 1].val)) {
+        ++run;
+      }
+      n = run - 1;
+      if (fwrite(&n, 1, 1, fp) != 1 || fwrite(&pixels[i], sizeof(pixel_t), run, fp) != (size_t)run) {
+        return false;
+      }
+    }
+    i += run;
+  }
+  return true;
+}
+
+static bool
+image_read_rle(FILE *fp, GLFWimage *image)
+{
+  pixel_t *pixels = image_pixels(image);
+  int len = calc_image_size(image);
+  int i = 0;
+  while (i < len) {
+    unsigned char n;
+    int run;
+    if (fread(&n, 1, 1, fp) != 1) {
+      return false;
+    }
+    run = (n & 0x7F) + 1;
+    if (i + run > len) {
+      return false;
+    }
+    if (n & 0x80) {
+      pixel_t pixel;
+      int j;
+      if (fread(&pixel, sizeof(pixel_t), 1, fp) != 1) {
+        return false;
+      }
+      for (j = 0; j < run; ++j) {
+        pixels[i + j] = pixel;
+      }
+    } else if (fread(&pixels[i], sizeof(pixel_t), run, fp) != (size_t)run) {
+      return false;
+    }
+    i += run;
+  }
+  return true;
+}
+
+/**
+ * @param [String] path
+ * @param [Boolean] compress run-length encode the pixels
+ */
+static mrb_value
+image_dump(mrb_state *mrb, mrb_value self)
+{
+  GLFWimage *image = get_image(mrb, self);
+  char *path;
+  mrb_bool compress = false;
+  unsigned char header[IMAGE_FILE_HEADER_SIZE];
+  FILE *fp;
+  bool ok;
+  mrb_get_args(mrb, "z|b", &path, &compress);
+  memcpy(header, IMAGE_FILE_MAGIC, 4);
+  header[4] = IMAGE_FILE_VERSION;
+  header[5] = IMAGE_FORMAT_RGBA8;
+  header[6] = compress ? IMAGE_COMPRESSION_RLE : IMAGE_COMPRESSION_NONE;
+  header[7] = 0;
+  put_u32(&header[8], (uint32_t)image->width);
+  put_u32(&header[12], (uint32_t)image->height);
+  fp = fopen(path, "wb");
+  if (!fp) {
+    mrb_raisef(mrb, E_RUNTIME_ERROR, "Could not open %S for writing", mrb_str_new_cstr(mrb, path));
+  }
+  ok = fwrite(header, sizeof(header), 1, fp) == 1;
+  if (ok && compress) {
+    ok = image_write_rle(fp, image);
+  } else if (ok) {
+    size_t size = (size_t)calc_image_pixels_size(image);
+    ok = size == 0 || fwrite(image->pixels, size, 1, fp) == 1;
+  }
+  ok = (fclose(fp) == 0) && ok;
+  if (!ok) {
+    mrb_raisef(mrb, E_RUNTIME_ERROR, "Could not write %S", mrb_str_new_cstr(mrb, path));
+  }
+  return self;
+}
+
+/* state shared between image_s_load and its ensure clause */
+typedef struct image_load
+{
+  FILE *fp;
+  const char *path;
+  struct RClass *klass;
+  uint32_t width;
+  uint32_t height;
+  unsigned char compression;
+} image_load;
+
+static void
+image_load_raise(mrb_state *mrb, const char *path, const char *error)
+{
+  mrb_raisef(mrb, E_RUNTIME_ERROR, "Could not load %S: %S",
+             mrb_str_new_cstr(mrb, path), mrb_str_new_cstr(mrb, error));
+}
+
+static mrb_value
+image_load_body(mrb_state *mrb, mrb_value data)
+{
+  image_load *load = (image_load*)mrb_cptr(data);
+  mrb_value argv[2];
+  mrb_value result;
+  GLFWimage *image;
+  argv[0] = mrb_fixnum_value(load->width);
+  argv[1] = mrb_fixnum_value(load->height);
+  result = mrb_obj_new(mrb, load->klass, 2, argv);
+  image = get_image(mrb, result);
+  if (load->compression == IMAGE_COMPRESSION_RLE) {
+    if (!image_read_rle(load->fp, image)) {
+      image_load_raise(mrb, load->path, "truncated or corrupt data");
+    }
+  } else {
+    size_t size = (size_t)calc_image_pixels_size(image);
+    if (size > 0 && fread(image->pixels, size, 1, load->fp) != 1) {
+      image_load_raise(mrb, load->path, "truncated data");
+    }
+  }
+  return result;
+}
+
+static mrb_value
+image_load_close(mrb_state *mrb, mrb_value data)
+{
+  fclose(((image_load*)mrb_cptr(data))->fp);
+  return mrb_nil_value();
+}
+
+/**
+ * Uncompressed files are read straight into the pixel buffer.
+ * @param [String] path file written by Image#dump
+ * @return [GLFW::Image]
+ */
+static mrb_value
+image_s_load(mrb_state *mrb, mrb_value klass)
+{
+  char *path;
+  unsigned char header[IMAGE_FILE_HEADER_SIZE];
+  image_load load;
+  mrb_value data;
+  const char *error = NULL;
+  mrb_get_args(mrb, "z", &path);
+  load.fp = fopen(path, "rb");
+  if (!load.fp) {
+    mrb_raisef(mrb, E_RUNTIME_ERROR, "Could not open %S", mrb_str_new_cstr(mrb, path));
+  }
+  if (fread(header, sizeof(header), 1, load.fp) != 1 || memcmp(header, IMAGE_FILE_MAGIC, 4) != 0) {
+    error = "not an image file";
+  } else if (header[4] != IMAGE_FILE_VERSION) {
+    error = "unsupported version";
+  } else if (header[5] != IMAGE_FORMAT_RGBA8 ||
+             (header[6] != IMAGE_COMPRESSION_NONE && header[6] != IMAGE_COMPRESSION_RLE)) {
+    error = "unsupported format";
+  }
+  load.path = path;
+  load.klass = mrb_class_ptr(klass);
+  load.width = get_u32(&header[8]);
+  load.height = get_u32(&header[12]);
+  load.compression = header[6];
+  /* each dimension on its own, then the product */
+  if (!error && (load.width > INT_MAX / NUM_OF_CHANNELS ||
+                 load.height > INT_MAX / NUM_OF_CHANNELS ||
+                 (load.width > 0 && load.height > INT_MAX / NUM_OF_CHANNELS / load.width))) {
+    error = "image too large";
+  }
+  if (error) {
+    fclose(load.fp);
+    image_load_raise(mrb, path, error);
+  }
+  /* the file is closed even when allocating or reading the image raises */
+  data = mrb_cptr_value(mrb, &load);
+  return mrb_ensure(mrb, image_load_body, data, image_load_close, data);
+}
+
 void
 mrb_glfw3_image_init(mrb_state *mrb, struct RClass *mod)
 {
@@ -186,4 +571,8 @@ mrb_glfw3_image_init(mrb_state *mrb, struct RClass *mod)
   mrb_define_method(mrb, mrb_glfw3_image_class, "clear",      image_clear,         MRB_ARGS_REQ(1));
   mrb_define_method(mrb, mrb_glfw3_image_class, "[]",         image_aget,          MRB_ARGS_REQ(2));
   mrb_define_method(mrb, mrb_glfw3_image_class, "[]=",        image_aset,          MRB_ARGS_REQ(3));
+  mrb_define_method(mrb, mrb_glfw3_image_class, "resize",     image_resize,        MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, mrb_glfw3_image_class, "diff",       image_diff,          MRB_ARGS_ARG(1, 2));
+  mrb_define_method(mrb, mrb_glfw3_image_class, "dump",       image_dump,          MRB_ARGS_ARG(1, 1));
+  mrb_define_class_method(mrb, mrb_glfw3_image_class, "load", image_s_load,        MRB_ARGS_REQ(1));
 }
@@ -0,0 +1,424 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include <mruby.h>
+#include <mruby/data.h>
+#include <mruby/array.h>
+
+#include <GLFW/glfw3.h>
+
+#include "glfw3_input_map.h"
+#include "glfw3_private.h"
+
+#define INPUT_UNBOUND -1
+#define INPUT_DOWN 1
+#define INPUT_PRESSED 2
+#define INPUT_RELEASED 4
+
+/* A joystick button or axis, read once per update */
+typedef struct joystick_binding
+{
+  int joystick;
+  int index;
+  bool axis;
+  float deadzone;
+  float direction;
+  int action;
+} joystick_binding;
+
+/* held counts the keys and mouse buttons currently down for the action,
+ * edges the transitions they made since the last update */
+typedef struct action_state
+{
+  int held;
+  int edges;
+  int flags;
+  float value;
+} action_state;
+
+struct mrb_glfw3_input_map
+{
+  int keys[GLFW_KEY_LAST + 1];
+  int mouse_buttons[GLFW_MOUSE_BUTTON_LAST + 1];
+  unsigned char keys_down[GLFW_KEY_LAST + 1];
+  unsigned char mouse_buttons_down[GLFW_MOUSE_BUTTON_LAST + 1];
+  joystick_binding *joy;
+  mrb_int joy_len;
+  mrb_int joy_capa;
+  mrb_int action_count;
+  action_state *actions;
+};
+
+static struct RClass *mrb_glfw3_input_map_class;
+
+void
+mrb_glfw3_input_map_free(mrb_state *mrb, void *ptr)
+{
+  mrb_glfw3_input_map *map = ptr;
+  if (map) {
+    if (map->joy) {
+      mrb_free(mrb, map->joy);
+    }
+    if (map->actions) {
+      mrb_free(mrb, map->actions);
+    }
+    mrb_free(mrb, map);
+  }
+}
+
+const struct mrb_data_type mrb_glfw3_input_map_type = { "GLFWinputmap", mrb_glfw3_input_map_free };
+
+static inline mrb_glfw3_input_map*
+get_input_map(mrb_state *mrb, mrb_value self)
+{
+  return (mrb_glfw3_input_map*)mrb_data_get_ptr(mrb, self, &mrb_glfw3_input_map_type);
+}
+
+static void
+input_map_reset(mrb_glfw3_input_map *map)
+{
+  mrb_int i;
+  for (i = 0; i <= GLFW_KEY_LAST; ++i) {
+    map->keys[i] = INPUT_UNBOUND;
+  }
+  for (i = 0; i <= GLFW_MOUSE_BUTTON_LAST; ++i) {
+    map->mouse_buttons[i] = INPUT_UNBOUND;
+  }
+  memset(map->keys_down, 0, sizeof(map->keys_down));
+  memset(map->mouse_buttons_down, 0, sizeof(map->mouse_buttons_down));
+  map->joy_len = 0;
+  memset(map->actions, 0, sizeof(action_state) * map->action_count);
+}
+
+/* Returns the action id of value, nil unbinds */
+static int
+input_map_action(mrb_state *mrb, mrb_glfw3_input_map *map, mrb_value value)
+{
+  mrb_int action;
+  if (mrb_nil_p(value)) {
+    return INPUT_UNBOUND;
+  }
+  action = mrb_int(mrb, value);
+  if (action < 0 || action >= map->action_count) {
+    mrb_raisef(mrb, E_ARGUMENT_ERROR, "action %S out of range", value);
+  }
+  return (int)action;
+}
+
+static void
+input_map_digital(mrb_glfw3_input_map *map, int action, unsigned char *down, int state)
+{
+  action_state *st = &map->actions[action];
+  if (state == GLFW_PRESS && !*down) {
+    *down = 1;
+    if (st->held++ == 0) {
+      st->edges |= INPUT_PRESSED;
+    }
+  } else if (state == GLFW_RELEASE && *down) {
+    *down = 0;
+    if (--st->held == 0) {
+      st->edges |= INPUT_RELEASED;
+    }
+  }
+}
+
+/* Rebinding a key or button that is down releases it from its old action */
+static void
+input_map_rebind(mrb_glfw3_input_map *map, int *slot, unsigned char *down, int action)
+{
+  if (*slot != INPUT_UNBOUND) {
+    input_map_digital(map, *slot, down, GLFW_RELEASE);
+  }
+  *down = 0;
+  *slot = action;
+}
+
+void
+mrb_glfw3_input_map_key(mrb_glfw3_input_map *map, int key, int scancode, int action, int mods)
+{
+  if (key < 0 || key > GLFW_KEY_LAST || map->keys[key] == INPUT_UNBOUND) {
+    return;
+  }
+  input_map_digital(map, map->keys[key], &map->keys_down[key], action);
+}
+
+void
+mrb_glfw3_input_map_mouse_button(mrb_glfw3_input_map *map, int button, int action, int mods)
+{
+  if (button < 0 || button > GLFW_MOUSE_BUTTON_LAST || map->mouse_buttons[button] == INPUT_UNBOUND) {
+    return;
+  }
+  input_map_digital(map, map->mouse_buttons[button], &map->mouse_buttons_down[button], action);
+}
+
+static void
+input_map_put_joystick(mrb_state *mrb, mrb_glfw3_input_map *map, const joystick_binding *binding)
+{
+  mrb_int i;
+  for (i = 0; i < map->joy_len; ++i) {
+    joystick_binding *b = &map->joy[i];
+    if (b->joystick == binding->joystick && b->index == binding->index &&
+        b->axis == binding->axis && b->direction == binding->direction) {
+      if (binding->action == INPUT_UNBOUND) {
+        *b = map->joy[--map->joy_len];
+      } else {
+        *b = *binding;
+      }
+      return;
+    }
+  }
+  if (binding->action == INPUT_UNBOUND) {
+    return;
+  }
+  if (map->joy_len == map->joy_capa) {
+    map->joy_capa = map->joy_capa ? map->joy_capa * 2 : 8;
+    map->joy = mrb_realloc(mrb, map->joy, sizeof(joystick_binding) * map->joy_capa);
+  }
+  map->joy[map->joy_len++] = *binding;
+}
+
+static void
+check_joystick(mrb_state *mrb, mrb_int joystick, mrb_int index)
+{
+  if (joystick < GLFW_JOYSTICK_1 || joystick > GLFW_JOYSTICK_LAST) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "invalid joystick");
+  }
+  if (index < 0) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "invalid joystick button or axis");
+  }
+}
+
+/**
+ * @param [Integer] action_count actions are numbered from 0 to action_count - 1
+ */
+static mrb_value
+input_map_initialize(mrb_state *mrb, mrb_value self)
+{
+  mrb_glfw3_input_map *map;
+  mrb_int action_count;
+  mrb_get_args(mrb, "i", &action_count);
+  if (action_count < 0) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "negative action count");
+  }
+  map = mrb_calloc(mrb, 1, sizeof(mrb_glfw3_input_map));
+  mrb_data_init(self, map, &mrb_glfw3_input_map_type);
+  map->action_count = action_count;
+  map->actions = mrb_calloc(mrb, action_count ? action_count : 1, sizeof(action_state));
+  input_map_reset(map);
+  return self;
+}
+
+/**
+ * @param [Integer] key GLFW::KEY_*
+ * @param [Integer, nil] action nil unbinds the key
+ */
+static mrb_value
+input_map_bind_key(mrb_state *mrb, mrb_value self)
+{
+  mrb_glfw3_input_map *map = get_input_map(mrb, self);
+  mrb_int key;
+  mrb_value action;
+  mrb_get_args(mrb, "io", &key, &action);
+  if (key < 0 || key > GLFW_KEY_LAST) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "invalid key");
+  }
+  input_map_rebind(map, &map->keys[key], &map->keys_down[key], input_map_action(mrb, map, action));
+  return self;
+}
+
+/**
+ * @param [Integer] button GLFW::MOUSE_BUTTON_*
+ * @param [Integer, nil] action nil unbinds the button
+ */
+static mrb_value
+input_map_bind_mouse_button(mrb_state *mrb, mrb_value self)
+{
+  mrb_glfw3_input_map *map = get_input_map(mrb, self);
+  mrb_int button;
+  mrb_value action;
+  mrb_get_args(mrb, "io", &button, &action);
+  if (button < 0 || button > GLFW_MOUSE_BUTTON_LAST) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "invalid mouse button");
+  }
+  input_map_rebind(map, &map->mouse_buttons[button], &map->mouse_buttons_down[button],
+                   input_map_action(mrb, map, action));
+  return self;
+}
+
+/**
+ * @param [Integer] joystick GLFW::JOYSTICK_*
+ * @param [Integer] button
+ * @param [Integer, nil] action nil unbinds the button
+ */
+static mrb_value
+input_map_bind_joystick_button(mrb_state *mrb, mrb_value self)
+{
+  mrb_glfw3_input_map *map = get_input_map(mrb, self);
+  mrb_int joystick, button;
+  mrb_value action;
+  joystick_binding binding;
+  mrb_get_args(mrb, "iio", &joystick, &button, &action);
+  check_joystick(mrb, joystick, button);
+  binding.joystick = (int)joystick;
+  binding.index = (int)button;
+  binding.axis = false;
+  binding.deadzone = 0.0f;
+  binding.direction = 1.0f;
+  binding.action = input_map_action(mrb, map, action);
+  input_map_put_joystick(mrb, map, &binding);
+  return self;
+}
+
+/**
+ * The action's value is the axis position past the deadzone in the given
+ * direction, scaled to 0..1.
+ * @param [Integer] joystick GLFW::JOYSTICK_*
+ * @param [Integer] axis
+ * @param [Integer, nil] action nil unbinds the axis direction
+ * @param [Float] deadzone optional, 0.2 by default
+ * @param [Integer] direction optional, 1 for the positive half of the axis
+ *   (the default), -1 for the negative one
+ */
+static mrb_value
+input_map_bind_joystick_axis(mrb_state *mrb, mrb_value self)
+{
+  mrb_glfw3_input_map *map = get_input_map(mrb, self);
+  mrb_int joystick, axis;
+  mrb_value action;
+  mrb_float deadzone = 0.2;
+  mrb_int direction = 1;
+  joystick_binding binding;
+  mrb_get_args(mrb, "iio|fi", &joystick, &axis, &action, &deadzone, &direction);
+  check_joystick(mrb, joystick, axis);
+  if (deadzone < 0.0 || deadzone >= 1.0) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "deadzone must be in 0...1");
+  }
+  if (direction != 1 && direction != -1) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "direction must be 1 or -1");
+  }
+  binding.joystick = (int)joystick;
+  binding.index = (int)axis;
+  binding.axis = true;
+  binding.deadzone = (float)deadzone;
+  binding.direction = (float)direction;
+  binding.action = input_map_action(mrb, map, action);
+  input_map_put_joystick(mrb, map, &binding);
+  return self;
+}
+
+/**
+ * Reads the joystick bindings and resolves the state of every action, call
+ * once per frame after GLFW.poll_events.
+ * @return [Array<Integer>] per action, a mask of DOWN, PRESSED (went down
+ *   since the last update) and RELEASED (went up since the last update)
+ */
+static mrb_value
+input_map_update(mrb_state *mrb, mrb_value self)
+{
+  mrb_glfw3_input_map *map = get_input_map(mrb, self);
+  const float *axes[GLFW_JOYSTICK_LAST + 1];
+  const unsigned char *buttons[GLFW_JOYSTICK_LAST + 1];
+  int axis_count[GLFW_JOYSTICK_LAST + 1];
+  int button_count[GLFW_JOYSTICK_LAST + 1];
+  bool polled[GLFW_JOYSTICK_LAST + 1];
+  mrb_value result;
+  mrb_int i;
+  memset(polled, 0, sizeof(polled));
+  if (map->joy_len > 0) {
+    mrb_glfw3_ensure_init(mrb);
+  }
+  for (i = 0; i < map->action_count; ++i) {
+    map->actions[i].value = map->actions[i].held > 0 ? 1.0f : 0.0f;
+  }
+  for (i = 0; i < map->joy_len; ++i) {
+    const joystick_binding *b = &map->joy[i];
+    int j = b->joystick;
+    float value = 0.0f;
+    if (!polled[j]) {
+      axes[j] = glfwGetJoystickAxes(j, &axis_count[j]);
+      buttons[j] = glfwGetJoystickButtons(j, &button_count[j]);
+      polled[j] = true;
+    }
+    if (b->axis) {
+      if (axes[j] && b->index < axis_count[j]) {
+        value = axes[j][b->index] * b->direction;
+        value = value <= b->deadzone ? 0.0f : (value - b->deadzone) / (1.0f - b->deadzone);
+      }
+    } else if (buttons[j] && b->index < button_count[j] && buttons[j][b->index] == GLFW_PRESS) {
+      value = 1.0f;
+    }
+    if (value > map->actions[b->action].value) {
+      map->actions[b->action].value = value;
+    }
+  }
+  result = mrb_ary_new_capa(mrb, map->action_count);
+  for (i = 0; i < map->action_count; ++i) {
+    action_state *st = &map->actions[i];
+    bool was_down = st->flags & INPUT_DOWN;
+    bool down = st->value > 0.0f;
+    bool pressed = !was_down && (down || (st->edges & INPUT_PRESSED));
+    st->flags = (down ? INPUT_DOWN : 0) |
+                (pressed ? INPUT_PRESSED : 0) |
+                ((was_down || pressed) && !down ? INPUT_RELEASED : 0);
+    st->edges = 0;
+    mrb_ary_push(mrb, result, mrb_fixnum_value(st->flags));
+  }
+  return result;
+}
+
+/**
+ * @param [Integer] action
+ * @return [Float] 0..1 as of the last update, 1 for keys and buttons
+ */
+static mrb_value
+input_map_value(mrb_state *mrb, mrb_value self)
+{
+  mrb_glfw3_input_map *map = get_input_map(mrb, self);
+  mrb_value action;
+  int index;
+  mrb_get_args(mrb, "o", &action);
+  index = input_map_action(mrb, map, action);
+  if (index == INPUT_UNBOUND) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "no action given");
+  }
+  return mrb_float_value(mrb, map->actions[index].value);
+}
+
+static mrb_value
+input_map_action_count(mrb_state *mrb, mrb_value self)
+{
+  return mrb_fixnum_value(get_input_map(mrb, self)->action_count);
+}
+
+/**
+ * Removes every binding and resets the action states.
+ */
+static mrb_value
+input_map_clear(mrb_state *mrb, mrb_value self)
+{
+  input_map_reset(get_input_map(mrb, self));
+  return self;
+}
+
+static const mrb_glfw3_const input_map_constants[] = {
+  MRB_GLFW3_CONST("DOWN", INPUT_DOWN),
+  MRB_GLFW3_CONST("PRESSED", INPUT_PRESSED),
+  MRB_GLFW3_CONST("RELEASED", INPUT_RELEASED),
+};
+
+void
+mrb_glfw3_input_map_init(mrb_state *mrb, struct RClass *mod)
+{
+  mrb_glfw3_input_map_class = mrb_define_class_under(mrb, mod, "InputMap", mrb->object_class);
+  MRB_SET_INSTANCE_TT(mrb_glfw3_input_map_class, MRB_TT_DATA);
+  mrb_define_method(mrb, mrb_glfw3_input_map_class, "initialize",           input_map_initialize,           MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, mrb_glfw3_input_map_class, "bind_key",             input_map_bind_key,             MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, mrb_glfw3_input_map_class, "bind_mouse_button",    input_map_bind_mouse_button,    MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, mrb_glfw3_input_map_class, "bind_joystick_button", input_map_bind_joystick_button, MRB_ARGS_REQ(3));
+  mrb_define_method(mrb, mrb_glfw3_input_map_class, "bind_joystick_axis",   input_map_bind_joystick_axis,   MRB_ARGS_REQ(3) | MRB_ARGS_OPT(2));
+  mrb_define_method(mrb, mrb_glfw3_input_map_class, "update",               input_map_update,               MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_glfw3_input_map_class, "value",                input_map_value,                MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, mrb_glfw3_input_map_class, "action_count",         input_map_action_count,         MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_glfw3_input_map_class, "clear",                input_map_clear,                MRB_ARGS_NONE());
+  mrb_glfw3_define_consts(mrb, mrb_glfw3_input_map_class, input_map_constants, MRB_GLFW3_CONST_COUNT(input_map_constants));
+}
@@ -0,0 +1,16 @@
+#ifndef MRB_GLFW3_INPUT_MAP_H
+#define MRB_GLFW3_INPUT_MAP_H
+
+#include <mruby.h>
+#include <mruby/data.h>
+#include <mruby/class.h>
+
+typedef struct mrb_glfw3_input_map mrb_glfw3_input_map;
+
+extern const struct mrb_data_type mrb_glfw3_input_map_type;
+void mrb_glfw3_input_map_init(mrb_state *mrb, struct RClass *mod);
+/* Called from the window callbacks of windows the map is attached to */
+void mrb_glfw3_input_map_key(mrb_glfw3_input_map *map, int key, int scancode, int action, int mods);
+void mrb_glfw3_input_map_mouse_button(mrb_glfw3_input_map *map, int button, int action, int mods);
+
+#endif
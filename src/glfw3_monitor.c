@@ -11,19 +11,74 @@
 #include <GLFW/glfw3.h>
 
 #include "glfw3_monitor.h"
+#include "glfw3_private.h"
 #include "glfw3_vid_mode.h"
 #include "glfw3_gamma_ramp.h"
 
 static struct RClass *mrb_glfw3_monitor_class;
 const struct mrb_data_type mrb_glfw3_monitor_type = { "GLFWmonitor", NULL };
 
+static mrb_state *monitor_MRB;
+/* Bumped on every monitor event and on terminate, anything derived from
+ * the monitor configuration is stale once it changes. */
+static int monitor_generation = 0;
+
+int
+mrb_glfw3_monitor_generation(void)
+{
+  return monitor_generation;
+}
+
+/* generation GLFW.monitor_layout was built for, -1 once a fullscreen switch
+ * changed a mode without touching the monitor configuration */
+static int layout_generation = -1;
+
+static void
+monitor_invalidate(mrb_state *mrb)
+{
+  ++monitor_generation;
+  mrb_glfw3_vid_mode_tables_flush(mrb);
+}
+
+void
+mrb_glfw3_monitor_layout_invalidate(void)
+{
+  layout_generation = -1;
+}
+
+static void
+glfw_monitor_callback_handler(GLFWmonitor *monitor, int event)
+{
+  mrb_value cb;
+  mrb_value argv[2];
+  monitor_invalidate(monitor_MRB);
+  cb = mrb_iv_get(monitor_MRB, mrb_obj_value(mrb_module_get(monitor_MRB, "GLFW")), mrb_intern_lit(monitor_MRB, "cb_monitor"));
+  if (mrb_nil_p(cb)) {
+    return;
+  }
+  argv[0] = mrb_glfw3_monitor_value(monitor_MRB, monitor);
+  argv[1] = mrb_fixnum_value(event);
+  mrb_yield_argv(monitor_MRB, cb, 2, argv);
+}
+
+/* Called after glfwInit, monitor events are always tracked */
+void
+mrb_glfw3_monitor_install(mrb_state *mrb)
+{
+  glfwSetMonitorCallback(glfw_monitor_callback_handler);
+}
+
+/* Called before glfwTerminate, which frees all monitors */
+void
+mrb_glfw3_monitor_reset(mrb_state *mrb)
+{
+  monitor_invalidate(mrb);
+}
+
 mrb_value
 mrb_glfw3_monitor_value(mrb_state *mrb, GLFWmonitor *mon)
 {
-  mrb_value monitor = mrb_obj_new(mrb, mrb_glfw3_monitor_class, 0, NULL);
-  DATA_PTR(monitor) = mon;
-  DATA_TYPE(monitor) = &mrb_glfw3_monitor_type;
-  return monitor;
+  return mrb_obj_value(mrb_data_object_alloc(mrb, mrb_glfw3_monitor_class, mon, &mrb_glfw3_monitor_type));
 }
 
 static mrb_value
@@ -33,24 +88,112 @@ glfw_s_monitors(mrb_state *mrb, mrb_value klass)
   int count;
   int i;
   GLFWmonitor **monitors;
-  result = mrb_ary_new(mrb);
+  mrb_glfw3_ensure_init(mrb);
   monitors = glfwGetMonitors(&count);
+  result = mrb_ary_new_capa(mrb, count);
   for (i = 0; i < count; ++i) {
     mrb_ary_push(mrb, result, mrb_glfw3_monitor_value(mrb, monitors[i]));
   }
   return result;
 }
 
+static mrb_value
+layout_column(mrb_state *mrb, mrb_value layout, const char *key, int count)
+{
+  mrb_value column = mrb_ary_new_capa(mrb, count);
+  mrb_hash_set(mrb, layout, mrb_symbol_value(mrb_intern_cstr(mrb, key)), column);
+  return column;
+}
+
+static void
+layout_freeze(mrb_state *mrb, mrb_value layout)
+{
+  mrb_value keys = mrb_hash_keys(mrb, layout);
+  mrb_int i;
+  for (i = 0; i < RARRAY_LEN(keys); ++i) {
+    mrb_obj_freeze(mrb, mrb_hash_get(mrb, layout, RARRAY_PTR(keys)[i]));
+  }
+  mrb_obj_freeze(mrb, layout);
+}
+
+/**
+ * Describes every monitor in one structure of parallel Arrays, indexed like
+ * GLFW.monitors. Built natively, frozen and shared until the next monitor
+ * event or fullscreen switch.
+ * @return [Hash] :monitors, :x, :y, :width, :height and :refresh_rate of
+ *   the current mode, :width_mm, :height_mm, :dpi_x, :dpi_y
+ */
+static mrb_value
+glfw_s_monitor_layout(mrb_state *mrb, mrb_value klass)
+{
+  mrb_sym cache_sym = mrb_intern_lit(mrb, "__monitor_layout");
+  mrb_value layout = mrb_iv_get(mrb, klass, cache_sym);
+  mrb_value monitors, xs, ys, widths, heights, rates, widths_mm, heights_mm, dpi_xs, dpi_ys;
+  GLFWmonitor **handles;
+  int count;
+  int i;
+  if (!mrb_nil_p(layout) && layout_generation == monitor_generation) {
+    return layout;
+  }
+  mrb_glfw3_ensure_init(mrb);
+  handles = glfwGetMonitors(&count);
+  if (!handles) {
+    count = 0;
+  }
+  layout = mrb_hash_new(mrb);
+  monitors = layout_column(mrb, layout, "monitors", count);
+  xs = layout_column(mrb, layout, "x", count);
+  ys = layout_column(mrb, layout, "y", count);
+  widths = layout_column(mrb, layout, "width", count);
+  heights = layout_column(mrb, layout, "height", count);
+  rates = layout_column(mrb, layout, "refresh_rate", count);
+  widths_mm = layout_column(mrb, layout, "width_mm", count);
+  heights_mm = layout_column(mrb, layout, "height_mm", count);
+  dpi_xs = layout_column(mrb, layout, "dpi_x", count);
+  dpi_ys = layout_column(mrb, layout, "dpi_y", count);
+  for (i = 0; i < count; ++i) {
+    const GLFWvidmode *mode = glfwGetVideoMode(handles[i]);
+    int x, y, width_mm, height_mm;
+    int width = mode ? mode->width : 0;
+    int height = mode ? mode->height : 0;
+    glfwGetMonitorPos(handles[i], &x, &y);
+    glfwGetMonitorPhysicalSize(handles[i], &width_mm, &height_mm);
+    mrb_ary_push(mrb, monitors, mrb_glfw3_monitor_value(mrb, handles[i]));
+    mrb_ary_push(mrb, xs, mrb_fixnum_value(x));
+    mrb_ary_push(mrb, ys, mrb_fixnum_value(y));
+    mrb_ary_push(mrb, widths, mrb_fixnum_value(width));
+    mrb_ary_push(mrb, heights, mrb_fixnum_value(height));
+    mrb_ary_push(mrb, rates, mrb_fixnum_value(mode ? mode->refreshRate : 0));
+    mrb_ary_push(mrb, widths_mm, mrb_fixnum_value(width_mm));
+    mrb_ary_push(mrb, heights_mm, mrb_fixnum_value(height_mm));
+    mrb_ary_push(mrb, dpi_xs, mrb_float_value(mrb, width_mm > 0 ? width * 25.4 / width_mm : 0.0));
+    mrb_ary_push(mrb, dpi_ys, mrb_float_value(mrb, height_mm > 0 ? height * 25.4 / height_mm : 0.0));
+  }
+  /* the layout is shared between callers, so it must not be mutated */
+  layout_freeze(mrb, layout);
+  mrb_iv_set(mrb, klass, cache_sym, layout);
+  layout_generation = monitor_generation;
+  return layout;
+}
+
 static mrb_value
 glfw_s_primary_monitor(mrb_state *mrb, mrb_value klass)
 {
-  GLFWmonitor *monitor = glfwGetPrimaryMonitor();
+  GLFWmonitor *monitor;
+  mrb_glfw3_ensure_init(mrb);
+  monitor = glfwGetPrimaryMonitor();
   return mrb_glfw3_monitor_value(mrb, monitor);
 }
 
+/**
+ * @yield [monitor, event] event is GLFW::CONNECTED or GLFW::DISCONNECTED
+ */
 static mrb_value
 glfw_s_set_monitor_callback(mrb_state *mrb, mrb_value klass)
 {
+  mrb_value blk = mrb_nil_value();
+  mrb_get_args(mrb, "&", &blk);
+  mrb_iv_set(mrb, klass, mrb_intern_lit(mrb, "cb_monitor"), blk);
   return klass;
 }
 
@@ -85,17 +228,13 @@ monitor_name(mrb_state *mrb, mrb_value self)
   return mrb_str_new_cstr(mrb, name);
 }
 
+/**
+ * @return [GLFW::VidModeList]
+ */
 static mrb_value
 monitor_vid_modes(mrb_state *mrb, mrb_value self)
 {
-  int count;
-  int i;
-  mrb_value result = mrb_ary_new(mrb);
-  const GLFWvidmode *vid_modes = glfwGetVideoModes(mrb_glfw3_get_monitor(mrb, self), &count);
-  for (i = 0; i < count; ++i) {
-    mrb_ary_push(mrb, result, mrb_glfw3_vid_mode_value(mrb, vid_modes[i]));
-  }
-  return result;
+  return mrb_glfw3_vid_mode_list_value(mrb, mrb_glfw3_get_monitor(mrb, self));
 }
 
 static mrb_value
@@ -132,9 +271,11 @@ monitor_set_gamma_ramp(mrb_state *mrb, mrb_value self)
 void
 mrb_glfw3_monitor_init(mrb_state* mrb, struct RClass *mod)
 {
+  monitor_MRB = mrb;
   mrb_define_class_method(mrb, mod, "monitors",             glfw_s_monitors,             MRB_ARGS_NONE());
   mrb_define_class_method(mrb, mod, "primary_monitor",      glfw_s_primary_monitor,      MRB_ARGS_NONE());
   mrb_define_class_method(mrb, mod, "set_monitor_callback", glfw_s_set_monitor_callback, MRB_ARGS_BLOCK());
+  mrb_define_class_method(mrb, mod, "monitor_layout",       glfw_s_monitor_layout,       MRB_ARGS_NONE());
 
   mrb_glfw3_monitor_class = mrb_define_class_under(mrb, mod, "Monitor", mrb->object_class);
   MRB_SET_INSTANCE_TT(mrb_glfw3_monitor_class, MRB_TT_DATA);
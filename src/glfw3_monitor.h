@@ -10,6 +10,10 @@
 extern const struct mrb_data_type mrb_glfw3_monitor_type;
 void mrb_glfw3_monitor_init(mrb_state *mrb, struct RClass *mod);
 mrb_value mrb_glfw3_monitor_value(mrb_state *mrb, GLFWmonitor *mon);
+void mrb_glfw3_monitor_install(mrb_state *mrb);
+void mrb_glfw3_monitor_reset(mrb_state *mrb);
+int mrb_glfw3_monitor_generation(void);
+void mrb_glfw3_monitor_layout_invalidate(void);
 
 static inline GLFWmonitor*
 mrb_glfw3_get_monitor(mrb_state *mrb, mrb_value self)
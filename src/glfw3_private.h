@@ -9,9 +9,50 @@
 #include <mruby/string.h>
 #include <mruby/array.h>
 #include <mruby/class.h>
+#include <mruby/hash.h>
+
+#include <GLFW/glfw3.h>
 
 #define E_GLFW_ERROR (mrb_class_get(mrb, "GLFWError"))
 
+#define MRB_GLFW3_VERSION_AT_LEAST(major, minor) \
+  (GLFW_VERSION_MAJOR > (major) || \
+   (GLFW_VERSION_MAJOR == (major) && GLFW_VERSION_MINOR >= (minor)))
+
+/* Resets the window hints to their defaults, keeping any headless hints
+ * requested through GLFW.init (see mrb_glfw.c) */
+void mrb_glfw3_default_window_hints(void);
+/* Calls glfwInit unless GLFW is already initialized (see mrb_glfw.c) */
+void mrb_glfw3_ensure_init(mrb_state *mrb);
+
+/* Integer constant tables; names are static so interning copies nothing */
+typedef struct mrb_glfw3_const
+{
+  const char *name;
+  size_t len;
+  mrb_int value;
+} mrb_glfw3_const;
+
+#define MRB_GLFW3_CONST(_name_, _value_) { _name_, sizeof(_name_) - 1, _value_ }
+#define MRB_GLFW3_CONST_COUNT(_table_) (sizeof(_table_) / sizeof((_table_)[0]))
+
+static inline void
+mrb_glfw3_define_consts(mrb_state *mrb, struct RClass *klass, const mrb_glfw3_const *consts, size_t count)
+{
+  mrb_value outer = mrb_obj_value(klass);
+  size_t i;
+  for (i = 0; i < count; ++i) {
+    mrb_const_set(mrb, outer, mrb_intern_static(mrb, consts[i].name, consts[i].len), mrb_fixnum_value(consts[i].value));
+  }
+}
+
+/* Maps Ruby symbols (by name) to GLFW enum values */
+typedef struct mrb_glfw3_sym_map
+{
+  const char *name;
+  int value;
+} mrb_glfw3_sym_map;
+
 static inline mrb_value
 mrb_glfw3_ary_delete(mrb_state *mrb, mrb_value ary, mrb_value obj)
 {
@@ -38,6 +79,15 @@ mrb_glfw3_uncache_object(mrb_state *mrb, mrb_value obj)
   mrb_glfw3_ary_delete(mrb, mrb_glfw3_cache(mrb), obj);
 }
 
+/* Live windows by id, so queued events find their window in one lookup */
+static inline mrb_value
+mrb_glfw3_window_registry(mrb_state *mrb)
+{
+  return mrb_iv_get(mrb,
+                    mrb_obj_value(mrb_module_get(mrb, "GLFW")),
+                    mrb_intern_lit(mrb, "__glfw_windows"));
+}
+
 static inline int
 mrb_glfw3_unpack_str_as_int(mrb_state *mrb, char *str)
 {
@@ -58,4 +108,25 @@ mrb_glfw3_ary_of(mrb_state *mrb, mrb_int size, mrb_value val)
   return ary;
 }
 
+/* Integers are passed through as-is, Symbols are looked up in the map */
+static inline int
+mrb_glfw3_sym_map_lookup(mrb_state *mrb, const mrb_glfw3_sym_map *map, mrb_value key, const char *what)
+{
+  const char *name;
+  if (mrb_fixnum_p(key)) {
+    return (int)mrb_fixnum(key);
+  }
+  if (!mrb_symbol_p(key)) {
+    mrb_raisef(mrb, E_TYPE_ERROR, "%S must be a Symbol or Integer", mrb_str_new_cstr(mrb, what));
+  }
+  name = mrb_sym2name(mrb, mrb_symbol(key));
+  for (; map->name; ++map) {
+    if (strcmp(map->name, name) == 0) {
+      return map->value;
+    }
+  }
+  mrb_raisef(mrb, E_ARGUMENT_ERROR, "unknown %S: %S", mrb_str_new_cstr(mrb, what), key);
+  return 0;
+}
+
 #endif
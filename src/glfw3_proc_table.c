@@ -0,0 +1,170 @@
+#include <stdbool.h>
+
+#include <mruby.h>
+#include <mruby/data.h>
+#include <mruby/array.h>
+#include <mruby/string.h>
+#include <mruby/variable.h>
+
+#include "glfw3_proc_table.h"
+#include "glfw3_private.h"
+
+typedef struct proc_table
+{
+  mrb_int size;
+  GLFWglproc procs[];
+} proc_table;
+
+static struct RClass *mrb_glfw3_proc_table_class;
+
+void
+mrb_glfw3_proc_table_free(mrb_state *mrb, void *ptr)
+{
+  if (ptr) {
+    mrb_free(mrb, ptr);
+  }
+}
+
+const struct mrb_data_type mrb_glfw3_proc_table_type = { "GLFWproctable", mrb_glfw3_proc_table_free };
+
+static inline proc_table*
+get_proc_table(mrb_state *mrb, mrb_value self)
+{
+  return (proc_table*)mrb_data_get_ptr(mrb, self, &mrb_glfw3_proc_table_type);
+}
+
+GLFWglproc
+mrb_glfw3_proc_table_get(mrb_state *mrb, mrb_value self, mrb_int index)
+{
+  proc_table *table = get_proc_table(mrb, self);
+  if (index < 0 || index >= table->size) {
+    return NULL;
+  }
+  return table->procs[index];
+}
+
+/* Returns the table cached on window if it was loaded with the same names,
+ * nil otherwise */
+static mrb_value
+proc_table_cached(mrb_state *mrb, mrb_value window, const mrb_value *names, mrb_int count)
+{
+  mrb_value cached = mrb_iv_get(mrb, window, mrb_intern_lit(mrb, "__proc_table"));
+  mrb_value cached_names;
+  mrb_int i;
+  if (mrb_nil_p(cached)) {
+    return cached;
+  }
+  cached_names = mrb_iv_get(mrb, cached, mrb_intern_lit(mrb, "__names"));
+  if (!mrb_array_p(cached_names) || RARRAY_LEN(cached_names) != count) {
+    return mrb_nil_value();
+  }
+  for (i = 0; i < count; ++i) {
+    if (!mrb_str_equal(mrb, RARRAY_PTR(cached_names)[i], names[i])) {
+      return mrb_nil_value();
+    }
+  }
+  return cached;
+}
+
+/**
+ * Resolves every name with glfwGetProcAddress for the current context, the
+ * table is cached on the context's window (see Window#proc_table) and
+ * returned again while the same names are requested.
+ * @param [Array<String>] names
+ * @return [GLFW::ProcTable]
+ */
+static mrb_value
+glfw_s_load_proc_table(mrb_state *mrb, mrb_value klass)
+{
+  mrb_value *names;
+  mrb_int count;
+  mrb_int i;
+  mrb_value result;
+  mrb_value window;
+  mrb_value copies;
+  proc_table *table;
+  GLFWwindow *context;
+  mrb_get_args(mrb, "a", &names, &count);
+  context = glfwGetCurrentContext();
+  if (!context) {
+    mrb_raise(mrb, E_GLFW_ERROR, "No current context to load procs from.");
+  }
+  window = mrb_obj_value(glfwGetWindowUserPointer(context));
+  result = proc_table_cached(mrb, window, names, count);
+  if (!mrb_nil_p(result)) {
+    return result;
+  }
+  result = mrb_obj_new(mrb, mrb_glfw3_proc_table_class, 0, NULL);
+  table = mrb_calloc(mrb, 1, sizeof(proc_table) + sizeof(GLFWglproc) * count);
+  table->size = count;
+  DATA_PTR(result) = table;
+  DATA_TYPE(result) = &mrb_glfw3_proc_table_type;
+  /* copied so later changes to the caller's Strings do not affect the cache */
+  copies = mrb_ary_new_capa(mrb, count);
+  for (i = 0; i < count; ++i) {
+    mrb_value name = names[i];
+    table->procs[i] = glfwGetProcAddress(mrb_string_value_cstr(mrb, &name));
+    mrb_ary_push(mrb, copies, mrb_str_dup(mrb, name));
+  }
+  mrb_iv_set(mrb, result, mrb_intern_lit(mrb, "__names"), copies);
+  mrb_iv_set(mrb, window, mrb_intern_lit(mrb, "__proc_table"), result);
+  return result;
+}
+
+static mrb_value
+proc_table_size(mrb_state *mrb, mrb_value self)
+{
+  return mrb_fixnum_value(get_proc_table(mrb, self)->size);
+}
+
+/**
+ * @param [Integer] index position of the name given to GLFW.load_proc_table
+ * @return [Object, nil] cptr to the function or nil if it could not be resolved
+ */
+static mrb_value
+proc_table_aget(mrb_state *mrb, mrb_value self)
+{
+  mrb_int index;
+  GLFWglproc proc;
+  mrb_get_args(mrb, "i", &index);
+  proc = mrb_glfw3_proc_table_get(mrb, self, index);
+  if (!proc) {
+    return mrb_nil_value();
+  }
+  return mrb_cptr_value(mrb, (void*)proc);
+}
+
+static mrb_value
+proc_table_loaded_p(mrb_state *mrb, mrb_value self)
+{
+  mrb_int index;
+  mrb_get_args(mrb, "i", &index);
+  return mrb_bool_value(mrb_glfw3_proc_table_get(mrb, self, index) != NULL);
+}
+
+static mrb_value
+proc_table_missing_count(mrb_state *mrb, mrb_value self)
+{
+  proc_table *table = get_proc_table(mrb, self);
+  mrb_int missing = 0;
+  mrb_int i;
+  for (i = 0; i < table->size; ++i) {
+    if (!table->procs[i]) {
+      ++missing;
+    }
+  }
+  return mrb_fixnum_value(missing);
+}
+
+void
+mrb_glfw3_proc_table_init(mrb_state *mrb, struct RClass *mod)
+{
+  mrb_define_class_method(mrb, mod, "load_proc_table", glfw_s_load_proc_table, MRB_ARGS_REQ(1));
+
+  mrb_glfw3_proc_table_class = mrb_define_class_under(mrb, mod, "ProcTable", mrb->object_class);
+  MRB_SET_INSTANCE_TT(mrb_glfw3_proc_table_class, MRB_TT_DATA);
+  mrb_define_method(mrb, mrb_glfw3_proc_table_class, "size",          proc_table_size,          MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_glfw3_proc_table_class, "[]",            proc_table_aget,          MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, mrb_glfw3_proc_table_class, "loaded?",       proc_table_loaded_p,      MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, mrb_glfw3_proc_table_class, "missing_count", proc_table_missing_count, MRB_ARGS_NONE());
+}
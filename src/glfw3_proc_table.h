@@ -0,0 +1,15 @@
+#ifndef MRB_GLFW3_PROC_TABLE_H
+#define MRB_GLFW3_PROC_TABLE_H
+
+#include <mruby.h>
+#include <mruby/data.h>
+#include <mruby/class.h>
+
+#include <GLFW/glfw3.h>
+
+extern const struct mrb_data_type mrb_glfw3_proc_table_type;
+void mrb_glfw3_proc_table_init(mrb_state *mrb, struct RClass *mod);
+/* For other bindings, returns NULL for unresolved or out of range entries */
+GLFWglproc mrb_glfw3_proc_table_get(mrb_state *mrb, mrb_value table, mrb_int index);
+
+#endif
@@ -0,0 +1,220 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <mruby.h>
+#include <mruby/class.h>
+#include <mruby/data.h>
+
+#include <GLFW/glfw3.h>
+
+#include "glfw3_image.h"
+#include "glfw3_private.h"
+#include "glfw3_readback.h"
+#include "glfw3_window.h"
+
+#ifndef APIENTRY
+#ifdef _WIN32
+#define APIENTRY __stdcall
+#else
+#define APIENTRY
+#endif
+#endif
+
+#define RB_GL_RGBA 0x1908
+#define RB_GL_UNSIGNED_BYTE 0x1401
+#define RB_GL_PACK_ROW_LENGTH 0x0D02
+#define RB_GL_PACK_ALIGNMENT 0x0D05
+#define RB_GL_PIXEL_PACK_BUFFER 0x88EB
+#define RB_GL_STREAM_READ 0x88E1
+#define RB_GL_READ_ONLY 0x88B8
+
+#define NUM_OF_CHANNELS 4
+
+typedef void (APIENTRY *read_pixels_fn)(int, int, int, int, unsigned int, unsigned int, void*);
+typedef void (APIENTRY *pixel_store_fn)(unsigned int, int);
+typedef void (APIENTRY *gen_buffers_fn)(int, unsigned int*);
+typedef void (APIENTRY *bind_buffer_fn)(unsigned int, unsigned int);
+typedef void (APIENTRY *buffer_data_fn)(unsigned int, ptrdiff_t, const void*, unsigned int);
+typedef void* (APIENTRY *map_buffer_fn)(unsigned int, unsigned int);
+typedef unsigned char (APIENTRY *unmap_buffer_fn)(unsigned int);
+
+/* GL entry points resolved from the window's context, and the pixel
+ * buffer used by the async path. GL objects die with the context, so
+ * nothing is deleted here. */
+struct mrb_glfw3_readback
+{
+  read_pixels_fn ReadPixels;
+  pixel_store_fn PixelStorei;
+  gen_buffers_fn GenBuffers;
+  bind_buffer_fn BindBuffer;
+  buffer_data_fn BufferData;
+  map_buffer_fn MapBuffer;
+  unmap_buffer_fn UnmapBuffer;
+  unsigned int pbo;
+  size_t pbo_size;
+  bool pending;
+  int pending_width;
+  int pending_height;
+};
+
+void
+mrb_glfw3_readback_free(mrb_state *mrb, struct mrb_glfw3_readback *readback)
+{
+  if (readback) {
+    mrb_free(mrb, readback);
+  }
+}
+
+static struct mrb_glfw3_readback*
+readback_get(mrb_state *mrb, mrb_glfw3_window *w)
+{
+  struct mrb_glfw3_readback *rb;
+  if (glfwGetCurrentContext() != w->handle) {
+    mrb_raise(mrb, E_GLFW_ERROR, "Window context is not current");
+  }
+  if (w->readback) {
+    return w->readback;
+  }
+  rb = mrb_calloc(mrb, 1, sizeof(struct mrb_glfw3_readback));
+  rb->ReadPixels = (read_pixels_fn)glfwGetProcAddress("glReadPixels");
+  rb->PixelStorei = (pixel_store_fn)glfwGetProcAddress("glPixelStorei");
+  if (!rb->ReadPixels || !rb->PixelStorei) {
+    mrb_free(mrb, rb);
+    mrb_raise(mrb, E_GLFW_ERROR, "glReadPixels is not available");
+  }
+  rb->GenBuffers = (gen_buffers_fn)glfwGetProcAddress("glGenBuffers");
+  rb->BindBuffer = (bind_buffer_fn)glfwGetProcAddress("glBindBuffer");
+  rb->BufferData = (buffer_data_fn)glfwGetProcAddress("glBufferData");
+  rb->MapBuffer = (map_buffer_fn)glfwGetProcAddress("glMapBuffer");
+  rb->UnmapBuffer = (unmap_buffer_fn)glfwGetProcAddress("glUnmapBuffer");
+  w->readback = rb;
+  return rb;
+}
+
+static bool
+readback_has_pbo(struct mrb_glfw3_readback *rb)
+{
+  return rb->GenBuffers && rb->BindBuffer && rb->BufferData && rb->MapBuffer && rb->UnmapBuffer;
+}
+
+static void
+flip_rows(unsigned char *pixels, int stride, int rows)
+{
+  int top, bottom, i;
+  for (top = 0, bottom = rows - 1; top < bottom; ++top, --bottom) {
+    unsigned char *a = pixels + (size_t)top * stride;
+    unsigned char *b = pixels + (size_t)bottom * stride;
+    for (i = 0; i < stride; ++i) {
+      unsigned char t = a[i];
+      a[i] = b[i];
+      b[i] = t;
+    }
+  }
+}
+
+/* Starts an async read of the top-left width x height region */
+static void
+readback_request(struct mrb_glfw3_readback *rb, int fb_height, int width, int height)
+{
+  size_t size = (size_t)width * height * NUM_OF_CHANNELS;
+  if (!rb->pbo) {
+    rb->GenBuffers(1, &rb->pbo);
+  }
+  rb->BindBuffer(RB_GL_PIXEL_PACK_BUFFER, rb->pbo);
+  if (rb->pbo_size != size) {
+    rb->BufferData(RB_GL_PIXEL_PACK_BUFFER, (ptrdiff_t)size, NULL, RB_GL_STREAM_READ);
+    rb->pbo_size = size;
+  }
+  rb->PixelStorei(RB_GL_PACK_ALIGNMENT, 4);
+  rb->PixelStorei(RB_GL_PACK_ROW_LENGTH, 0);
+  rb->ReadPixels(0, fb_height - height, width, height, RB_GL_RGBA, RB_GL_UNSIGNED_BYTE, NULL);
+  rb->BindBuffer(RB_GL_PIXEL_PACK_BUFFER, 0);
+  rb->pending = true;
+  rb->pending_width = width;
+  rb->pending_height = height;
+}
+
+/* Copies the pending read into image, flipping it; false if unavailable */
+static bool
+readback_collect(struct mrb_glfw3_readback *rb, GLFWimage *image)
+{
+  const unsigned char *src;
+  int width, height, y;
+  if (!rb->pending) {
+    return false;
+  }
+  rb->pending = false;
+  rb->BindBuffer(RB_GL_PIXEL_PACK_BUFFER, rb->pbo);
+  src = rb->MapBuffer(RB_GL_PIXEL_PACK_BUFFER, RB_GL_READ_ONLY);
+  if (!src) {
+    rb->BindBuffer(RB_GL_PIXEL_PACK_BUFFER, 0);
+    return false;
+  }
+  width = rb->pending_width < image->width ? rb->pending_width : image->width;
+  height = rb->pending_height < image->height ? rb->pending_height : image->height;
+  for (y = 0; y < height; ++y) {
+    memcpy(image->pixels + (size_t)y * image->width * NUM_OF_CHANNELS,
+           src + (size_t)(rb->pending_height - 1 - y) * rb->pending_width * NUM_OF_CHANNELS,
+           (size_t)width * NUM_OF_CHANNELS);
+  }
+  rb->UnmapBuffer(RB_GL_PIXEL_PACK_BUFFER);
+  rb->BindBuffer(RB_GL_PIXEL_PACK_BUFFER, 0);
+  return true;
+}
+
+/**
+ * Reads the top-left corner of the framebuffer, up to the image size,
+ * into image with the first row at the top. The window's context must be
+ * current.
+ * @param [GLFW::Image] image
+ * @param [Boolean] async read through a pixel buffer object; the image
+ *   then receives the frame requested by the previous call
+ * @return [GLFW::Image, nil] image, or nil when async has no frame yet
+ */
+static mrb_value
+window_read_framebuffer(mrb_state *mrb, mrb_value self)
+{
+  mrb_value image_obj;
+  mrb_bool async = false;
+  GLFWimage *image;
+  mrb_glfw3_window *w;
+  struct mrb_glfw3_readback *rb;
+  int fb_width, fb_height, width, height;
+  mrb_get_args(mrb, "o|b", &image_obj, &async);
+  image = mrb_data_get_ptr(mrb, image_obj, &mrb_glfw3_image_type);
+  if (!image) {
+    mrb_raise(mrb, E_TYPE_ERROR, "expected GLFW::Image");
+  }
+  if (!DATA_PTR(self)) {
+    mrb_raise(mrb, E_GLFW_ERROR, "Window has been destroyed");
+  }
+  w = mrb_data_get_ptr(mrb, self, &mrb_glfw3_window_type);
+  rb = readback_get(mrb, w);
+  glfwGetFramebufferSize(w->handle, &fb_width, &fb_height);
+  width = image->width < fb_width ? image->width : fb_width;
+  height = image->height < fb_height ? image->height : fb_height;
+  if (async && readback_has_pbo(rb)) {
+    bool filled = readback_collect(rb, image);
+    if (width > 0 && height > 0) {
+      readback_request(rb, fb_height, width, height);
+    }
+    return filled ? image_obj : mrb_nil_value();
+  }
+  if (width <= 0 || height <= 0) {
+    return image_obj;
+  }
+  rb->PixelStorei(RB_GL_PACK_ALIGNMENT, 4);
+  rb->PixelStorei(RB_GL_PACK_ROW_LENGTH, image->width);
+  rb->ReadPixels(0, fb_height - height, width, height, RB_GL_RGBA, RB_GL_UNSIGNED_BYTE, image->pixels);
+  rb->PixelStorei(RB_GL_PACK_ROW_LENGTH, 0);
+  flip_rows(image->pixels, image->width * NUM_OF_CHANNELS, height);
+  return image_obj;
+}
+
+void
+mrb_glfw3_readback_init(mrb_state *mrb, struct RClass *mod)
+{
+  struct RClass *window_class = mrb_class_get_under(mrb, mod, "Window");
+  mrb_define_method(mrb, window_class, "read_framebuffer", window_read_framebuffer, MRB_ARGS_ARG(1, 1));
+}
@@ -0,0 +1,12 @@
+#ifndef MRB_GLFW3_READBACK_H
+#define MRB_GLFW3_READBACK_H
+
+#include <mruby.h>
+#include <mruby/class.h>
+
+struct mrb_glfw3_readback;
+
+void mrb_glfw3_readback_init(mrb_state *mrb, struct RClass *mod);
+void mrb_glfw3_readback_free(mrb_state *mrb, struct mrb_glfw3_readback *readback);
+
+#endif
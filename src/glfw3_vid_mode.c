@@ -11,30 +11,199 @@
 
 #include <GLFW/glfw3.h>
 
+#include "glfw3_monitor.h"
+#include "glfw3_private.h"
 #include "glfw3_vid_mode.h"
 
 static struct RClass *mrb_glfw3_vid_mode_class;
+static struct RClass *mrb_glfw3_vid_mode_list_class;
+
+/* Released GLFWvidmode blocks are kept for reuse, modes are queried in
+ * bursts (Monitor#vid_modes) and are all the same size. */
+#define VID_MODE_POOL_MAX 64
+
+typedef union vid_mode_block
+{
+  union vid_mode_block *next;
+  GLFWvidmode mode;
+} vid_mode_block;
+
+static struct {
+  vid_mode_block *free;
+  int count;
+  bool closed;
+} vid_mode_pool;
 
 void
 mrb_glfw3_vid_mode_free(mrb_state *mrb, void *ptr)
 {
-  if (ptr) {
-    mrb_free(mrb, ptr);
+  vid_mode_block *block = ptr;
+  if (!block) {
+    return;
   }
+  if (vid_mode_pool.closed || vid_mode_pool.count >= VID_MODE_POOL_MAX) {
+    mrb_free(mrb, block);
+    return;
+  }
+  block->next = vid_mode_pool.free;
+  vid_mode_pool.free = block;
+  vid_mode_pool.count++;
 }
 
 const struct mrb_data_type mrb_glfw3_vid_mode_type = { "GLFWvidmode", mrb_glfw3_vid_mode_free };
 
+static GLFWvidmode*
+vid_mode_alloc(mrb_state *mrb)
+{
+  vid_mode_block *block = vid_mode_pool.free;
+  if (block) {
+    vid_mode_pool.free = block->next;
+    vid_mode_pool.count--;
+    return &block->mode;
+  }
+  return &((vid_mode_block*)mrb_malloc(mrb, sizeof(vid_mode_block)))->mode;
+}
+
+/* Releases the pool; blocks freed afterwards go straight to mrb_free */
+void
+mrb_glfw3_vid_mode_final(mrb_state *mrb)
+{
+  while (vid_mode_pool.free) {
+    vid_mode_block *next = vid_mode_pool.free->next;
+    mrb_free(mrb, vid_mode_pool.free);
+    vid_mode_pool.free = next;
+  }
+  vid_mode_pool.count = 0;
+  vid_mode_pool.closed = true;
+}
+
 mrb_value
 mrb_glfw3_vid_mode_value(mrb_state *mrb, GLFWvidmode vidmode)
 {
-  GLFWvidmode *vmode;
-  mrb_value result = mrb_obj_new(mrb, mrb_glfw3_vid_mode_class, 0, NULL);
-  vmode = mrb_malloc(mrb, sizeof(GLFWvidmode));
+  GLFWvidmode *vmode = vid_mode_alloc(mrb);
   *vmode = vidmode;
-  DATA_PTR(result) = vmode;
-  DATA_TYPE(result) = &mrb_glfw3_vid_mode_type;
-  return result;
+  return mrb_obj_value(mrb_data_object_alloc(mrb, mrb_glfw3_vid_mode_class, vmode, &mrb_glfw3_vid_mode_type));
+}
+
+/* Copy of a monitor's mode array, taken once per monitor generation since
+ * glfwGetVideoModes reallocates GLFW's own array on every call. Referenced
+ * by the registry while current and by each VidModeList. */
+typedef struct vid_mode_table
+{
+  struct vid_mode_table *next;
+  GLFWmonitor *monitor;
+  int generation;
+  mrb_int refs;
+  int count;
+  GLFWvidmode modes[];
+} vid_mode_table;
+
+static vid_mode_table *vid_mode_tables = NULL;
+
+static void
+vid_mode_table_release(mrb_state *mrb, vid_mode_table *table)
+{
+  if (table && --table->refs == 0) {
+    mrb_free(mrb, table);
+  }
+}
+
+void
+mrb_glfw3_vid_mode_tables_flush(mrb_state *mrb)
+{
+  while (vid_mode_tables) {
+    vid_mode_table *next = vid_mode_tables->next;
+    vid_mode_tables->next = NULL;
+    vid_mode_table_release(mrb, vid_mode_tables);
+    vid_mode_tables = next;
+  }
+}
+
+static void
+vid_mode_list_free(mrb_state *mrb, void *ptr)
+{
+  vid_mode_table_release(mrb, ptr);
+}
+
+const struct mrb_data_type mrb_glfw3_vid_mode_list_type = { "GLFWvidmodelist", vid_mode_list_free };
+
+mrb_value
+mrb_glfw3_vid_mode_list_value(mrb_state *mrb, GLFWmonitor *monitor)
+{
+  vid_mode_table *table;
+  const GLFWvidmode *modes;
+  int count = 0;
+  for (table = vid_mode_tables; table; table = table->next) {
+    if (table->monitor == monitor) {
+      break;
+    }
+  }
+  if (!table) {
+    modes = glfwGetVideoModes(monitor, &count);
+    if (!modes) {
+      count = 0;
+    }
+    table = mrb_malloc(mrb, sizeof(vid_mode_table) + sizeof(GLFWvidmode) * count);
+    table->monitor = monitor;
+    table->generation = mrb_glfw3_monitor_generation();
+    table->refs = 1;
+    table->count = count;
+    if (count > 0) {
+      memcpy(table->modes, modes, sizeof(GLFWvidmode) * count);
+    }
+    table->next = vid_mode_tables;
+    vid_mode_tables = table;
+  }
+  table->refs++;
+  return mrb_obj_value(mrb_data_object_alloc(mrb, mrb_glfw3_vid_mode_list_class, table, &mrb_glfw3_vid_mode_list_type));
+}
+
+static vid_mode_table*
+get_vid_mode_table(mrb_state *mrb, mrb_value self)
+{
+  vid_mode_table *table = mrb_data_get_ptr(mrb, self, &mrb_glfw3_vid_mode_list_type);
+  if (!table) {
+    mrb_raise(mrb, E_TYPE_ERROR, "uninitialized VidModeList");
+  }
+  if (table->generation != mrb_glfw3_monitor_generation()) {
+    mrb_raise(mrb, E_GLFW_ERROR, "monitor configuration changed, VidModeList is stale");
+  }
+  return table;
+}
+
+static mrb_value
+vid_mode_list_size(mrb_state *mrb, mrb_value self)
+{
+  return mrb_fixnum_value(get_vid_mode_table(mrb, self)->count);
+}
+
+/**
+ * @param [Integer] index negative values count from the end
+ * @return [GLFW::VidMode, nil]
+ */
+static mrb_value
+vid_mode_list_aref(mrb_state *mrb, mrb_value self)
+{
+  vid_mode_table *table = get_vid_mode_table(mrb, self);
+  mrb_int index;
+  mrb_get_args(mrb, "i", &index);
+  if (index < 0) {
+    index += table->count;
+  }
+  if (index < 0 || index >= table->count) {
+    return mrb_nil_value();
+  }
+  return mrb_glfw3_vid_mode_value(mrb, table->modes[index]);
+}
+
+/**
+ * @return [Boolean] false once the monitor configuration has changed
+ */
+static mrb_value
+vid_mode_list_valid_p(mrb_state *mrb, mrb_value self)
+{
+  vid_mode_table *table = mrb_data_get_ptr(mrb, self, &mrb_glfw3_vid_mode_list_type);
+  return mrb_bool_value(table && table->generation == mrb_glfw3_monitor_generation());
 }
 
 static GLFWvidmode*
@@ -82,6 +251,7 @@ vid_mode_refresh_rate(mrb_state *mrb, mrb_value self)
 void
 mrb_glfw3_vid_mode_init(mrb_state *mrb, struct RClass *mod)
 {
+  vid_mode_pool.closed = false;
   mrb_glfw3_vid_mode_class = mrb_define_class_under(mrb, mod, "VidMode", mrb->object_class);
   MRB_SET_INSTANCE_TT(mrb_glfw3_vid_mode_class, MRB_TT_DATA);
   mrb_define_method(mrb, mrb_glfw3_vid_mode_class, "width",        vid_mode_width,        MRB_ARGS_NONE());
@@ -90,4 +260,10 @@ mrb_glfw3_vid_mode_init(mrb_state *mrb, struct RClass *mod)
   mrb_define_method(mrb, mrb_glfw3_vid_mode_class, "green_bits",   vid_mode_green_bits,   MRB_ARGS_NONE());
   mrb_define_method(mrb, mrb_glfw3_vid_mode_class, "blue_bits",    vid_mode_blue_bits,    MRB_ARGS_NONE());
   mrb_define_method(mrb, mrb_glfw3_vid_mode_class, "refresh_rate", vid_mode_refresh_rate, MRB_ARGS_NONE());
+
+  mrb_glfw3_vid_mode_list_class = mrb_define_class_under(mrb, mod, "VidModeList", mrb->object_class);
+  MRB_SET_INSTANCE_TT(mrb_glfw3_vid_mode_list_class, MRB_TT_DATA);
+  mrb_define_method(mrb, mrb_glfw3_vid_mode_list_class, "size",   vid_mode_list_size,    MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_glfw3_vid_mode_list_class, "[]",     vid_mode_list_aref,    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, mrb_glfw3_vid_mode_list_class, "valid?", vid_mode_list_valid_p, MRB_ARGS_NONE());
 }
@@ -10,5 +10,9 @@
 extern const struct mrb_data_type mrb_glfw3_video_mode_type;
 void mrb_glfw3_vid_mode_init(mrb_state *mrb, struct RClass *mod);
 mrb_value mrb_glfw3_vid_mode_value(mrb_state *mrb, GLFWvidmode vidmode);
+void mrb_glfw3_vid_mode_final(mrb_state *mrb);
+/* Shares one snapshot of the monitor's modes between VidModeLists */
+mrb_value mrb_glfw3_vid_mode_list_value(mrb_state *mrb, GLFWmonitor *monitor);
+void mrb_glfw3_vid_mode_tables_flush(mrb_state *mrb);
 
 #endif
@@ -1,3 +1,4 @@
+#include <limits.h>
 #include <stdbool.h>
 
 #include <mruby.h>
@@ -7,12 +8,19 @@
 #include <mruby/hash.h>
 #include <mruby/variable.h>
 #include <mruby/string.h>
+#include <mruby/numeric.h>
 
 #include <GLFW/glfw3.h>
 
 #include "glfw3_private.h"
 #include "glfw3_window.h"
 #include "glfw3_monitor.h"
+#include "glfw3_drop_list.h"
+#include "glfw3_extensions.h"
+#include "glfw3_hint_set.h"
+#include "glfw3_image.h"
+#include "glfw3_input_map.h"
+#include "glfw3_readback.h"
 
 /* START THE HAX */
 typedef unsigned int uint;
@@ -21,164 +29,534 @@ typedef unsigned int uint;
 #define float_cast(_mrb_, a) mrb_float_value(_mrb_, a)
 #define double_cast(_mrb_, a) mrb_float_value(_mrb_, a)
 #define string_cast(_mrb_, a) mrb_str_new_cstr(_mrb_, a)
+#define drop_list_cast(_mrb_, size, a) mrb_glfw3_drop_list_value(_mrb_, size, a)
 #define to_cast(name) name ## _cast
+#define uint_arg mrb_int
+#define int_arg mrb_int
+#define float_arg mrb_float
+#define double_arg mrb_float
+#define uint_fmt "i"
+#define int_fmt "i"
+#define float_fmt "f"
+#define double_fmt "f"
+#define to_arg(name) name ## _arg
+#define to_fmt(name) name ## _fmt
+#define uint_store(ev, n, a) ((ev)->i[n] = (int)(a))
+#define int_store(ev, n, a) ((ev)->i[n] = (a))
+#define float_store(ev, n, a) ((ev)->d[n] = (a))
+#define double_store(ev, n, a) ((ev)->d[n] = (a))
+#define to_store(name) name ## _store
+#define EVENT_TYPE(_base_) EVENT_TYPE_ ## _base_
 #define CALLBACK_IDENT(_base_) window_ ## _base_ ## _func
 #define CALLBACK_NAME(_base_) "window_" #_base_ "_func"
-#define GET_CALLBACK(_func_) mrb_iv_get(cb_MRB, mrb_window, mrb_intern_lit(cb_MRB, CALLBACK_NAME(_func_)))
+#define CALLBACK_SLOT(_base_) CALLBACK_SLOT_ ## _base_
+#define INJECT_IDENT(_base_) window_inject_ ## _base_
 #define GET_WINDOW_REF(_mrb_, window) mrb_obj_value(glfwGetWindowUserPointer(window))
 
-#define MAKE_MRB_CALLBACK(_name_, _func_) \
+/* Every window callback with a fixed signature, as
+ *   X(name, GLFW setter, signature, hook)
+ * where the signature spells the argument types: v for none, i int, u uint,
+ * d double and f float. Each entry generates the C callback, the
+ * set_<name>_callback and inject_<name> methods and its packed event
+ * handling. The hook, unless none, is called natively with every event
+ * before it is queued or yielded, see HOOK_input. char and drop are written
+ * out by hand. */
+#define WINDOW_CALLBACKS(X) \
+  X(pos,              glfwSetWindowPosCallback,       ii,   none)  \
+  X(size,             glfwSetWindowSizeCallback,      ii,   none)  \
+  X(close,            glfwSetWindowCloseCallback,     v,    none)  \
+  X(refresh,          glfwSetWindowRefreshCallback,   v,    none)  \
+  X(focus,            glfwSetWindowFocusCallback,     i,    none)  \
+  X(iconify,          glfwSetWindowIconifyCallback,   i,    none)  \
+  X(framebuffer_size, glfwSetFramebufferSizeCallback, ii,   none)  \
+  X(key,              glfwSetKeyCallback,             iiii, input) \
+  X(char_mods,        glfwSetCharModsCallback,        ui,   none)  \
+  X(mouse_button,     glfwSetMouseButtonCallback,     iii,  input) \
+  X(cursor_pos,       glfwSetCursorPosCallback,       dd,   history) \
+  X(cursor_enter,     glfwSetCursorEnterCallback,     i,    none)  \
+  X(scroll,           glfwSetScrollCallback,          dd,   none)  \
+  WINDOW_CALLBACKS_33(X)
+
+#if MRB_GLFW3_VERSION_AT_LEAST(3, 3)
+#define WINDOW_CALLBACKS_33(X) \
+  X(maximize,         glfwSetWindowMaximizeCallback,     i,  none) \
+  X(content_scale,    glfwSetWindowContentScaleCallback, ff, none)
+#else
+#define WINDOW_CALLBACKS_33(X)
+#endif
+
+/* Hooks: the call made with the callback arguments, and whether the hook
+ * needs the GLFW callback installed even without a block */
+#define HOOK_none(_func_, ...)
+#define HOOK_input(_func_, window, ...) \
+  if (mrb_glfw3_window_data(window)->input_map) { \
+    mrb_glfw3_input_map_ ## _func_(mrb_glfw3_window_data(window)->input_map, __VA_ARGS__); \
+  }
+#define HOOK_history(_func_, window, ...) window_history_ ## _func_(window, __VA_ARGS__);
+#define HOOK_ACTIVE_none(w) false
+#define HOOK_ACTIVE_input(w) ((w)->input_map != NULL)
+#define HOOK_ACTIVE_history(w) ((w)->cursor_history.capa > 0)
+
+/* Per signature: the callback definition, its argument count, the call
+ * replaying a packed event and whether the arguments are stored in d */
+#define SIG_THUNK_v(_func_, _hook_)        CALLBACK_SETUP_N0(_func_, _hook_)
+#define SIG_THUNK_i(_func_, _hook_)        CALLBACK_SETUP_N1(_func_, _hook_, int)
+#define SIG_THUNK_ii(_func_, _hook_)       CALLBACK_SETUP_N2(_func_, _hook_, int, int)
+#define SIG_THUNK_ui(_func_, _hook_)       CALLBACK_SETUP_N2(_func_, _hook_, uint, int)
+#define SIG_THUNK_dd(_func_, _hook_)       CALLBACK_SETUP_N2(_func_, _hook_, double, double)
+#define SIG_THUNK_ff(_func_, _hook_)       CALLBACK_SETUP_N2(_func_, _hook_, float, float)
+#define SIG_THUNK_iii(_func_, _hook_)      CALLBACK_SETUP_N3(_func_, _hook_, int, int, int)
+#define SIG_THUNK_iiii(_func_, _hook_)     CALLBACK_SETUP_N4(_func_, _hook_, int, int, int, int)
+#define SIG_ARGC_v    0
+#define SIG_ARGC_i    1
+#define SIG_ARGC_ii   2
+#define SIG_ARGC_ui   2
+#define SIG_ARGC_dd   2
+#define SIG_ARGC_ff   2
+#define SIG_ARGC_iii  3
+#define SIG_ARGC_iiii 4
+#define SIG_DISPATCH_v(_func_)    CALLBACK_IDENT(_func_)(window)
+#define SIG_DISPATCH_i(_func_)    CALLBACK_IDENT(_func_)(window, ev->i[0])
+#define SIG_DISPATCH_ii(_func_)   CALLBACK_IDENT(_func_)(window, ev->i[0], ev->i[1])
+#define SIG_DISPATCH_ui(_func_)   CALLBACK_IDENT(_func_)(window, (uint)ev->i[0], ev->i[1])
+#define SIG_DISPATCH_dd(_func_)   CALLBACK_IDENT(_func_)(window, ev->d[0], ev->d[1])
+#define SIG_DISPATCH_ff(_func_)   CALLBACK_IDENT(_func_)(window, (float)ev->d[0], (float)ev->d[1])
+#define SIG_DISPATCH_iii(_func_)  CALLBACK_IDENT(_func_)(window, ev->i[0], ev->i[1], ev->i[2])
+#define SIG_DISPATCH_iiii(_func_) CALLBACK_IDENT(_func_)(window, ev->i[0], ev->i[1], ev->i[2], ev->i[3])
+#define SIG_FLOAT_v    false
+#define SIG_FLOAT_i    false
+#define SIG_FLOAT_ii   false
+#define SIG_FLOAT_ui   false
+#define SIG_FLOAT_dd   true
+#define SIG_FLOAT_ff   true
+#define SIG_FLOAT_iii  false
+#define SIG_FLOAT_iiii false
+
+/* Whether the GLFW callback has to be installed for w */
+#define CALLBACK_NEEDED(w, _func_, _hook_) \
+  (event_queue.enabled || !mrb_nil_p((w)->callbacks[CALLBACK_SLOT(_func_)].blk) || HOOK_ACTIVE_ ## _hook_(w))
+
+#define MAKE_MRB_CALLBACK(_name_, _func_, _hook_) \
 static mrb_value                                                          \
 window_set_ ## _func_ ## _callback(mrb_state *mrb, mrb_value self)        \
 {                                                                         \
   mrb_value blk;                                                          \
+  mrb_glfw3_window *w;                                                    \
   mrb_get_args(mrb, "&", &blk);                                           \
-  if (mrb_nil_p(blk)) {                                                   \
-    _name_(get_window(mrb, self), NULL);                                  \
-  } else {                                                                \
-    _name_(get_window(mrb, self), CALLBACK_IDENT(_func_));                 \
-  }                                                                       \
-  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, CALLBACK_NAME(_func_)), blk); \
+  window_store_callback(mrb, self, CALLBACK_SLOT(_func_),                 \
+                        mrb_intern_lit(mrb, CALLBACK_NAME(_func_)), blk); \
+  w = get_window_data(mrb, self);                                         \
+  _name_(w->handle, CALLBACK_NEEDED(w, _func_, _hook_) ?                  \
+                    CALLBACK_IDENT(_func_) : NULL);                       \
   return blk;                                                             \
 }
 
-#define CALLBACK_SETUP_N0(_name_, _func_) \
+/* Arguments past the block's arity are never boxed, see window_call_begin */
+#define CALLBACK_SETUP_N0(_func_, _hook_) \
 static void CALLBACK_IDENT(_func_)(GLFWwindow *window) { \
-  mrb_value argv[1];           \
-  mrb_value mrb_window = GET_WINDOW_REF(cb_MRB, window); \
-  const int id = mrb_gc_arena_save(cb_MRB); \
-  argv[0] = mrb_window;        \
-  mrb_yield_argv(cb_MRB, GET_CALLBACK(_func_), 1, argv); \
-  mrb_gc_arena_restore(cb_MRB, id); \
+  window_call call; \
+  HOOK_ ## _hook_(_func_, window) \
+  if (event_queue.enabled) { \
+    event_queue_push(window, EVENT_TYPE(_func_)); \
+    return; \
+  } \
+  if (!window_call_begin(window, CALLBACK_SLOT(_func_), 0, &call)) return; \
+  window_call_end(&call); \
 } \
-MAKE_MRB_CALLBACK(_name_, _func_);
+static mrb_value INJECT_IDENT(_func_)(mrb_state *mrb, mrb_value self) { \
+  CALLBACK_IDENT(_func_)(get_window(mrb, self)); \
+  return self; \
+}
 
-#define CALLBACK_SETUP_N1(_name_, _func_, _t0_) \
+#define CALLBACK_SETUP_N1(_func_, _hook_, _t0_) \
 static void CALLBACK_IDENT(_func_)(GLFWwindow *window, _t0_ p0) { \
-  mrb_value argv[2];           \
-  mrb_value mrb_window = GET_WINDOW_REF(cb_MRB, window); \
-  const int id = mrb_gc_arena_save(cb_MRB); \
-  argv[0] = mrb_window;    \
-  argv[1] = to_cast(_t0_)(cb_MRB, p0); \
-  mrb_yield_argv(cb_MRB, GET_CALLBACK(_func_), 2, argv); \
-  mrb_gc_arena_restore(cb_MRB, id); \
+  window_call call; \
+  HOOK_ ## _hook_(_func_, window, p0) \
+  if (event_queue.enabled) { \
+    event_record *ev = event_queue_push(window, EVENT_TYPE(_func_)); \
+    to_store(_t0_)(ev, 0, p0); \
+    return; \
+  } \
+  if (!window_call_begin(window, CALLBACK_SLOT(_func_), 1, &call)) return; \
+  if (call.argc > 1) call.argv[1] = to_cast(_t0_)(cb_MRB, p0); \
+  window_call_end(&call); \
 } \
-MAKE_MRB_CALLBACK(_name_, _func_);
+static mrb_value INJECT_IDENT(_func_)(mrb_state *mrb, mrb_value self) { \
+  to_arg(_t0_) p0; \
+  mrb_get_args(mrb, to_fmt(_t0_), &p0); \
+  CALLBACK_IDENT(_func_)(get_window(mrb, self), (_t0_)p0); \
+  return self; \
+}
 
-#define CALLBACK_SETUP_N2(_name_, _func_, _t0_, _t1_) \
+#define CALLBACK_SETUP_N2(_func_, _hook_, _t0_, _t1_) \
 static void CALLBACK_IDENT(_func_)(GLFWwindow *window, _t0_ p0, _t1_ p1) { \
-  mrb_value argv[3];     \
-  mrb_value mrb_window = GET_WINDOW_REF(cb_MRB, window); \
-  const int id = mrb_gc_arena_save(cb_MRB); \
-  argv[0] = mrb_window;     \
-  argv[1] = to_cast(_t0_)(cb_MRB, p0); \
-  argv[2] = to_cast(_t1_)(cb_MRB, p1); \
-  mrb_yield_argv(cb_MRB, GET_CALLBACK(_func_), 3, argv); \
-  mrb_gc_arena_restore(cb_MRB, id); \
+  window_call call; \
+  HOOK_ ## _hook_(_func_, window, p0, p1) \
+  if (event_queue.enabled) { \
+    event_record *ev = event_queue_push(window, EVENT_TYPE(_func_)); \
+    to_store(_t0_)(ev, 0, p0); \
+    to_store(_t1_)(ev, 1, p1); \
+    return; \
+  } \
+  if (!window_call_begin(window, CALLBACK_SLOT(_func_), 2, &call)) return; \
+  if (call.argc > 1) call.argv[1] = to_cast(_t0_)(cb_MRB, p0); \
+  if (call.argc > 2) call.argv[2] = to_cast(_t1_)(cb_MRB, p1); \
+  window_call_end(&call); \
 } \
-MAKE_MRB_CALLBACK(_name_, _func_);
+static mrb_value INJECT_IDENT(_func_)(mrb_state *mrb, mrb_value self) { \
+  to_arg(_t0_) p0; \
+  to_arg(_t1_) p1; \
+  mrb_get_args(mrb, to_fmt(_t0_) to_fmt(_t1_), &p0, &p1); \
+  CALLBACK_IDENT(_func_)(get_window(mrb, self), (_t0_)p0, (_t1_)p1); \
+  return self; \
+}
 
-#define CALLBACK_SETUP_N3(_name_, _func_, _t0_, _t1_, _t2_) \
+#define CALLBACK_SETUP_N3(_func_, _hook_, _t0_, _t1_, _t2_) \
 static void CALLBACK_IDENT(_func_)(GLFWwindow *window, _t0_ p0, _t1_ p1, _t2_ p2) { \
-  mrb_value argv[4];     \
-  mrb_value mrb_window = GET_WINDOW_REF(cb_MRB, window); \
-  const int id = mrb_gc_arena_save(cb_MRB); \
-  argv[0] = mrb_window;     \
-  argv[1] = to_cast(_t0_)(cb_MRB, p0); \
-  argv[2] = to_cast(_t1_)(cb_MRB, p1); \
-  argv[3] = to_cast(_t2_)(cb_MRB, p2); \
-  mrb_yield_argv(cb_MRB, GET_CALLBACK(_func_), 4, argv); \
-  mrb_gc_arena_restore(cb_MRB, id); \
+  window_call call; \
+  HOOK_ ## _hook_(_func_, window, p0, p1, p2) \
+  if (event_queue.enabled) { \
+    event_record *ev = event_queue_push(window, EVENT_TYPE(_func_)); \
+    to_store(_t0_)(ev, 0, p0); \
+    to_store(_t1_)(ev, 1, p1); \
+    to_store(_t2_)(ev, 2, p2); \
+    return; \
+  } \
+  if (!window_call_begin(window, CALLBACK_SLOT(_func_), 3, &call)) return; \
+  if (call.argc > 1) call.argv[1] = to_cast(_t0_)(cb_MRB, p0); \
+  if (call.argc > 2) call.argv[2] = to_cast(_t1_)(cb_MRB, p1); \
+  if (call.argc > 3) call.argv[3] = to_cast(_t2_)(cb_MRB, p2); \
+  window_call_end(&call); \
 } \
-MAKE_MRB_CALLBACK(_name_, _func_);
+static mrb_value INJECT_IDENT(_func_)(mrb_state *mrb, mrb_value self) { \
+  to_arg(_t0_) p0; \
+  to_arg(_t1_) p1; \
+  to_arg(_t2_) p2; \
+  mrb_get_args(mrb, to_fmt(_t0_) to_fmt(_t1_) to_fmt(_t2_), &p0, &p1, &p2); \
+  CALLBACK_IDENT(_func_)(get_window(mrb, self), (_t0_)p0, (_t1_)p1, (_t2_)p2); \
+  return self; \
+}
 
-#define CALLBACK_SETUP_N4(_name_, _func_, _t0_, _t1_, _t2_, _t3_) \
+#define CALLBACK_SETUP_N4(_func_, _hook_, _t0_, _t1_, _t2_, _t3_) \
 static void CALLBACK_IDENT(_func_)(GLFWwindow *window, _t0_ p0, _t1_ p1, _t2_ p2, _t3_ p3) { \
-  mrb_value argv[5];     \
-  mrb_value mrb_window = GET_WINDOW_REF(cb_MRB, window); \
-  const int id = mrb_gc_arena_save(cb_MRB); \
-  argv[0] = mrb_window;     \
-  argv[1] = to_cast(_t0_)(cb_MRB, p0); \
-  argv[2] = to_cast(_t1_)(cb_MRB, p1); \
-  argv[3] = to_cast(_t2_)(cb_MRB, p2); \
-  argv[4] = to_cast(_t3_)(cb_MRB, p3); \
-  mrb_yield_argv(cb_MRB, GET_CALLBACK(_func_), 5, argv); \
-  mrb_gc_arena_restore(cb_MRB, id); \
+  window_call call; \
+  HOOK_ ## _hook_(_func_, window, p0, p1, p2, p3) \
+  if (event_queue.enabled) { \
+    event_record *ev = event_queue_push(window, EVENT_TYPE(_func_)); \
+    to_store(_t0_)(ev, 0, p0); \
+    to_store(_t1_)(ev, 1, p1); \
+    to_store(_t2_)(ev, 2, p2); \
+    to_store(_t3_)(ev, 3, p3); \
+    return; \
+  } \
+  if (!window_call_begin(window, CALLBACK_SLOT(_func_), 4, &call)) return; \
+  if (call.argc > 1) call.argv[1] = to_cast(_t0_)(cb_MRB, p0); \
+  if (call.argc > 2) call.argv[2] = to_cast(_t1_)(cb_MRB, p1); \
+  if (call.argc > 3) call.argv[3] = to_cast(_t2_)(cb_MRB, p2); \
+  if (call.argc > 4) call.argv[4] = to_cast(_t3_)(cb_MRB, p3); \
+  window_call_end(&call); \
 } \
-MAKE_MRB_CALLBACK(_name_, _func_);
+static mrb_value INJECT_IDENT(_func_)(mrb_state *mrb, mrb_value self) { \
+  to_arg(_t0_) p0; \
+  to_arg(_t1_) p1; \
+  to_arg(_t2_) p2; \
+  to_arg(_t3_) p3; \
+  mrb_get_args(mrb, to_fmt(_t0_) to_fmt(_t1_) to_fmt(_t2_) to_fmt(_t3_), &p0, &p1, &p2, &p3); \
+  CALLBACK_IDENT(_func_)(get_window(mrb, self), (_t0_)p0, (_t1_)p1, (_t2_)p2, (_t3_)p3); \
+  return self; \
+}
 
-#define CALLBACK_SETUP_N_ary(_name_, _func_, _t_, _cast_) \
+/* Variable length callbacks are not queued, they always yield */
+#define CALLBACK_SETUP_N_ary(_func_, _t_, _cast_) \
 static void CALLBACK_IDENT(_func_)(GLFWwindow *window, int size, _t_ p0) { \
-  mrb_value argv[2]; \
-  mrb_value data; \
-  int i; \
-  mrb_value mrb_window = GET_WINDOW_REF(cb_MRB, window); \
-  const int id = mrb_gc_arena_save(cb_MRB); \
-  data = mrb_ary_new(cb_MRB); \
-  for (i = 0; i < size; ++i) { \
-    mrb_ary_push(cb_MRB, data, to_cast(_cast_)(cb_MRB, p0[i])); \
-  } \
-  argv[0] = mrb_window; \
-  argv[1] = data; \
-  mrb_yield_argv(cb_MRB, GET_CALLBACK(_func_), 2, argv); \
-  mrb_gc_arena_restore(cb_MRB, id); \
+  window_call call; \
+  if (!window_call_begin(window, CALLBACK_SLOT(_func_), 1, &call)) return; \
+  if (call.argc > 1) call.argv[1] = to_cast(_cast_)(cb_MRB, size, p0); \
+  window_call_end(&call); \
 } \
-MAKE_MRB_CALLBACK(_name_, _func_);
+static mrb_value INJECT_IDENT(_func_)(mrb_state *mrb, mrb_value self) { \
+  mrb_value *vals; \
+  mrb_value buf; \
+  mrb_int len; \
+  mrb_int i; \
+  _t_ data; \
+  mrb_get_args(mrb, "a", &vals, &len); \
+  /* backed by a String so it is collected even if the callback raises */ \
+  buf = mrb_str_buf_new(mrb, sizeof(*data) * (len + 1)); \
+  data = (_t_)RSTRING_PTR(buf); \
+  for (i = 0; i < len; ++i) { \
+    data[i] = mrb_string_value_cstr(mrb, &vals[i]); \
+  } \
+  CALLBACK_IDENT(_func_)(get_window(mrb, self), (int)len, data); \
+  return self; \
+}
 /* END OF HAX */
 
 
+#define WINDOW_STATE_STRIDE 6
+#define CURSOR_SAMPLE_STRIDE 3
+
 static struct RClass *mrb_glfw3_window_class;
 static mrb_state *cb_MRB;
 
+/* Event types for packed event records, see Window.pack_event */
+enum {
+  EVENT_TYPE_pos = 1,
+  EVENT_TYPE_size,
+  EVENT_TYPE_close,
+  EVENT_TYPE_refresh,
+  EVENT_TYPE_focus,
+  EVENT_TYPE_iconify,
+  EVENT_TYPE_framebuffer_size,
+  EVENT_TYPE_key,
+  EVENT_TYPE_char,
+  EVENT_TYPE_char_mods,
+  EVENT_TYPE_mouse_button,
+  EVENT_TYPE_cursor_pos,
+  EVENT_TYPE_cursor_enter,
+  EVENT_TYPE_scroll,
+  EVENT_TYPE_maximize,
+  EVENT_TYPE_content_scale
+};
+
+/* Index of each callback's block in mrb_glfw3_window.callbacks */
+#define CALLBACK_SLOT_ENTRY(_func_, _name_, _sig_, _hook_) CALLBACK_SLOT(_func_),
+enum {
+  WINDOW_CALLBACKS(CALLBACK_SLOT_ENTRY)
+  CALLBACK_SLOT(char),
+  CALLBACK_SLOT(drop),
+  CALLBACK_SLOT_COUNT
+};
+
+/* Block of a callback, mirrored from its ivar (which keeps it alive) so the
+ * C callbacks need no ivar lookup */
+typedef struct mrb_glfw3_window_callback
+{
+  mrb_value blk;
+  /* arguments yielded including the window, or -1 for all of them */
+  int argc;
+} mrb_glfw3_window_callback;
+
+/* A single packed event, integer arguments are stored in i, floating point
+ * arguments (cursor_pos, scroll and content_scale) in d. */
+typedef struct event_record
+{
+  int type;
+  int window;
+  int i[4];
+  double d[2];
+} event_record;
+
+/* Events from every window are appended here instead of being yielded
+ * while the event queue is enabled, see GLFW.event_queue= */
+static struct {
+  bool enabled;
+  event_record *buf;
+  mrb_int len;
+  mrb_int capa;
+} event_queue = { false, NULL, 0, 0 };
+
+static int window_last_id = 0;
+
+static event_record*
+event_queue_push(GLFWwindow *window, int type)
+{
+  event_record *ev;
+  if (event_queue.len == event_queue.capa) {
+    mrb_int capa = event_queue.capa ? event_queue.capa * 2 : 256;
+    event_queue.buf = mrb_realloc(cb_MRB, event_queue.buf, sizeof(event_record) * capa);
+    event_queue.capa = capa;
+  }
+  ev = &event_queue.buf[event_queue.len++];
+  memset(ev, 0, sizeof(*ev));
+  ev->type = type;
+  ev->window = mrb_glfw3_window_data(window)->id;
+  return ev;
+}
+
+/* A block call in progress, see window_call_begin */
+typedef struct window_call
+{
+  mrb_value blk;
+  int argc;
+  int ai;
+  mrb_value argv[5];
+} window_call;
+
+/* Returns false when the window has no block in slot, otherwise prepares
+ * argv with the window. Only the first argc - 1 of the nargs callback
+ * arguments are then boxed, as many as the block takes. */
+static inline bool
+window_call_begin(GLFWwindow *window, int slot, int nargs, window_call *call)
+{
+  mrb_glfw3_window_callback *cb = &mrb_glfw3_window_data(window)->callbacks[slot];
+  if (mrb_nil_p(cb->blk)) {
+    return false;
+  }
+  call->blk = cb->blk;
+  call->argc = (cb->argc < 0 || cb->argc > nargs + 1) ? nargs + 1 : cb->argc;
+  call->argv[0] = GET_WINDOW_REF(cb_MRB, window);
+  call->ai = mrb_gc_arena_save(cb_MRB);
+  return true;
+}
+
+static inline void
+window_call_end(window_call *call)
+{
+  mrb_yield_argv(cb_MRB, call->blk, call->argc, call->argv);
+  mrb_gc_arena_restore(cb_MRB, call->ai);
+}
+
 void
-window_free(mrb_state *mrb, void *ptr)
+mrb_glfw3_event_queue_reset(mrb_state *mrb)
 {
-  if (ptr) {
-    glfwDestroyWindow((GLFWwindow*)ptr);
+  if (event_queue.buf) {
+    mrb_free(mrb, event_queue.buf);
   }
+  event_queue.buf = NULL;
+  event_queue.len = 0;
+  event_queue.capa = 0;
 }
 
-const struct mrb_data_type mrb_glfw3_window_type = { "GLFWwindow", window_free };
+void
+mrb_glfw3_window_free(mrb_state *mrb, void *ptr)
+{
+  mrb_glfw3_window *w = ptr;
+  if (w) {
+    if (w->handle) {
+      glfwDestroyWindow(w->handle);
+    }
+    if (w->text.buf) {
+      mrb_free(mrb, w->text.buf);
+    }
+    if (w->extensions.bits) {
+      mrb_free(mrb, w->extensions.bits);
+    }
+    if (w->callbacks) {
+      mrb_free(mrb, w->callbacks);
+    }
+    if (w->cursor_history.buf) {
+      mrb_free(mrb, w->cursor_history.buf);
+    }
+    mrb_glfw3_readback_free(mrb, w->readback);
+    mrb_free(mrb, w);
+  }
+}
+
+const struct mrb_data_type mrb_glfw3_window_type = { "GLFWwindow", mrb_glfw3_window_free };
+
+static inline mrb_glfw3_window*
+get_window_data(mrb_state *mrb, mrb_value self)
+{
+  /* destroy clears the data type as well, so check before the type check */
+  if (!DATA_PTR(self)) {
+    mrb_raise(mrb, E_GLFW_ERROR, "Window has been destroyed");
+  }
+  return (mrb_glfw3_window*)mrb_data_get_ptr(mrb, self, &mrb_glfw3_window_type);
+}
 
 static inline GLFWwindow*
 get_window(mrb_state *mrb, mrb_value self)
 {
-  return (GLFWwindow*)mrb_data_get_ptr(mrb, self, &mrb_glfw3_window_type);
+  return get_window_data(mrb, self)->handle;
+}
+
+static void window_sync_callbacks(mrb_state *mrb, mrb_value self);
+
+/* Sets the block of the callback in slot, both in its ivar so it is marked
+ * and natively for the C callbacks */
+static void
+window_store_callback(mrb_state *mrb, mrb_value self, int slot, mrb_sym name, mrb_value blk)
+{
+  mrb_glfw3_window_callback *cb = &get_window_data(mrb, self)->callbacks[slot];
+  mrb_iv_set(mrb, self, name, blk);
+  cb->blk = blk;
+  cb->argc = mrb_nil_p(blk) ? 0 : (int)mrb_fixnum(mrb_funcall(mrb, blk, "arity", 0));
 }
 
 /**
  * @param [Integer] w width of the window
  * @param [Integer] h height of the window
  * @param [String] title for the window
- * @param [GLFW::Monitor] monitor
- * @param [GLFW::Window] share
+ * @param [GLFW::Monitor, nil] monitor
+ * @param [GLFW::Window, nil] share
+ * @param [Hash] opts optional, as the last argument
+ *   hints: [GLFW::HintSet] applied over the default hints before creation
  */
 static mrb_value
 window_initialize(mrb_state *mrb, mrb_value self)
 {
   mrb_int w, h;
   char *title;
+  mrb_value *rest;
+  mrb_int restc;
   GLFWwindow* win;
   GLFWmonitor* monitor = NULL;
-  GLFWwindow* share = NULL;
-  mrb_get_args(mrb, "iiz|dd",
-    &w, &h, &title,
-    &monitor, &mrb_glfw3_monitor_type,
-    &share, mrb_glfw3_window_type);
-  win = glfwCreateWindow(w, h, title, monitor, share);
+  mrb_glfw3_window* share = NULL;
+  mrb_glfw3_window* data;
+  mrb_value hints = mrb_nil_value();
+  int i;
+  mrb_get_args(mrb, "iiz*", &w, &h, &title, &rest, &restc);
+  mrb_glfw3_ensure_init(mrb);
+  if (restc > 0 && mrb_hash_p(rest[restc - 1])) {
+    hints = mrb_hash_get(mrb, rest[--restc], mrb_symbol_value(mrb_intern_lit(mrb, "hints")));
+  }
+  if (restc > 2) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "wrong number of arguments");
+  }
+  if (restc > 0 && !mrb_nil_p(rest[0])) {
+    monitor = mrb_data_check_get_ptr(mrb, rest[0], &mrb_glfw3_monitor_type);
+    if (!monitor) {
+      mrb_raise(mrb, E_TYPE_ERROR, "expected GLFW::Monitor");
+    }
+  }
+  if (restc > 1 && !mrb_nil_p(rest[1])) {
+    share = mrb_data_check_get_ptr(mrb, rest[1], &mrb_glfw3_window_type);
+    if (!share) {
+      mrb_raise(mrb, E_TYPE_ERROR, "expected GLFW::Window");
+    }
+  }
+  if (!mrb_nil_p(hints)) {
+    mrb_glfw3_hint_set_apply(mrb, hints);
+  }
+  data = mrb_calloc(mrb, 1, sizeof(mrb_glfw3_window));
+  data->callbacks = mrb_malloc(mrb, sizeof(mrb_glfw3_window_callback) * CALLBACK_SLOT_COUNT);
+  for (i = 0; i < CALLBACK_SLOT_COUNT; ++i) {
+    data->callbacks[i].blk = mrb_nil_value();
+    data->callbacks[i].argc = 0;
+  }
+  win = glfwCreateWindow(w, h, title, monitor, share ? share->handle : NULL);
+  if (!mrb_nil_p(hints)) {
+    /* the set only applies to this window */
+    mrb_glfw3_default_window_hints();
+  }
+  if (monitor) {
+    mrb_glfw3_monitor_layout_invalidate();
+  }
   if (!win) {
+    mrb_glfw3_window_free(mrb, data);
     mrb_raise(mrb, E_GLFW_ERROR, "Could not create Window.");
   }
-  mrb_data_init(self, win, &mrb_glfw3_window_type);
+  data->handle = win;
+  data->id = ++window_last_id;
+  mrb_data_init(self, data, &mrb_glfw3_window_type);
   glfwSetWindowUserPointer(win, mrb_obj_ptr(self));
   mrb_glfw3_cache_object(mrb, self);
+  mrb_hash_set(mrb, mrb_glfw3_window_registry(mrb), mrb_fixnum_value(data->id), self);
+  if (event_queue.enabled) {
+    window_sync_callbacks(mrb, self);
+  }
   return self;
 }
 
 static mrb_value
 window_destroy(mrb_state *mrb, mrb_value self)
 {
-  window_free(mrb, get_window(mrb, self));
+  if (DATA_PTR(self)) {
+    mrb_glfw3_window *w = get_window_data(mrb, self);
+    mrb_hash_delete_key(mrb, mrb_glfw3_window_registry(mrb), mrb_fixnum_value(w->id));
+    mrb_glfw3_window_free(mrb, w);
+  }
   DATA_PTR(self) = NULL;
   DATA_TYPE(self) = NULL;
   mrb_glfw3_uncache_object(mrb, self);
@@ -188,7 +566,13 @@ window_destroy(mrb_state *mrb, mrb_value self)
 static mrb_value
 window_make_current(mrb_state *M, mrb_value self)
 {
-  return glfwMakeContextCurrent(get_window(M, self)), self;
+  mrb_glfw3_window *w = DATA_PTR(self) ? get_window_data(M, self) : NULL;
+  /* a destroyed window detaches the current context */
+  glfwMakeContextCurrent(w ? w->handle : NULL);
+  if (w) {
+    mrb_glfw3_extensions_update(M, w);
+  }
+  return self;
 }
 
 static mrb_value
@@ -360,6 +744,77 @@ window_get_monitor(mrb_state *mrb, mrb_value self)
   return mrb_glfw3_monitor_value(mrb, glfwGetWindowMonitor(get_window(mrb, self)));
 }
 
+/**
+ * Switches between fullscreen on monitor and windowed mode when nil.
+ * @param [GLFW::Monitor, nil] monitor
+ * @param [Integer] x
+ * @param [Integer] y
+ * @param [Integer] w
+ * @param [Integer] h
+ * @param [Integer] refresh_rate GLFW::DONT_CARE for the highest available
+ */
+static mrb_value
+window_set_monitor(mrb_state *mrb, mrb_value self)
+{
+  mrb_value monitor_obj;
+  mrb_int x, y, w, h, refresh_rate = GLFW_DONT_CARE;
+  GLFWmonitor *monitor = NULL;
+  mrb_get_args(mrb, "oiiii|i", &monitor_obj, &x, &y, &w, &h, &refresh_rate);
+  if (!mrb_nil_p(monitor_obj)) {
+    monitor = mrb_data_check_get_ptr(mrb, monitor_obj, &mrb_glfw3_monitor_type);
+    if (!monitor) {
+      mrb_raise(mrb, E_TYPE_ERROR, "expected GLFW::Monitor");
+    }
+  }
+  glfwSetWindowMonitor(get_window(mrb, self), monitor, x, y, w, h, refresh_rate);
+  /* a fullscreen switch changes the mode, refresh rate and dpi in the
+   * layout but not the list of modes */
+  mrb_glfw3_monitor_layout_invalidate();
+  return self;
+}
+
+/**
+ * @param [Array<GLFW::Image>, GLFW::Image, nil] images candidate icon
+ *   sizes, the system picks the closest; nil or [] restores the default
+ */
+static mrb_value
+window_set_icon(mrb_state *mrb, mrb_value self)
+{
+  mrb_value images;
+  mrb_value ary;
+  GLFWwindow *window = get_window(mrb, self);
+  GLFWimage *icons;
+  mrb_int len;
+  mrb_int i;
+  mrb_get_args(mrb, "o", &images);
+  if (mrb_nil_p(images)) {
+    glfwSetWindowIcon(window, 0, NULL);
+    return images;
+  }
+  ary = mrb_array_p(images) ? images : mrb_ary_new_from_values(mrb, 1, &images);
+  len = RARRAY_LEN(ary);
+  for (i = 0; i < len; ++i) {
+    mrb_data_check_type(mrb, RARRAY_PTR(ary)[i], &mrb_glfw3_image_type);
+  }
+  icons = mrb_malloc(mrb, sizeof(GLFWimage) * (len > 0 ? len : 1));
+  for (i = 0; i < len; ++i) {
+    icons[i] = *(GLFWimage*)DATA_PTR(RARRAY_PTR(ary)[i]);
+  }
+  glfwSetWindowIcon(window, (int)len, len > 0 ? icons : NULL);
+  mrb_free(mrb, icons);
+  return images;
+}
+
+/**
+ * @return [GLFW::ProcTable, nil] the table last loaded while this window's
+ *                               context was current
+ */
+static mrb_value
+window_get_proc_table(mrb_state *mrb, mrb_value self)
+{
+  return mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "__proc_table"));
+}
+
 static mrb_value
 window_get_window_attrib(mrb_state *mrb, mrb_value self)
 {
@@ -386,30 +841,587 @@ window_set_input_mode(mrb_state *mrb, mrb_value self)
   return self;
 }
 
-CALLBACK_SETUP_N2(glfwSetWindowPosCallback, pos, int, int);
-CALLBACK_SETUP_N2(glfwSetWindowSizeCallback, size, int, int);
-CALLBACK_SETUP_N0(glfwSetWindowCloseCallback, close);
-CALLBACK_SETUP_N0(glfwSetWindowRefreshCallback, refresh);
-CALLBACK_SETUP_N1(glfwSetWindowFocusCallback, focus, int);
-CALLBACK_SETUP_N1(glfwSetWindowIconifyCallback, iconify, int);
-CALLBACK_SETUP_N2(glfwSetFramebufferSizeCallback, framebuffer_size, int, int);
-CALLBACK_SETUP_N4(glfwSetKeyCallback, key, int, int, int, int);
-CALLBACK_SETUP_N1(glfwSetCharCallback, char, uint);
-CALLBACK_SETUP_N2(glfwSetCharModsCallback, char_mods, uint, int);
-CALLBACK_SETUP_N3(glfwSetMouseButtonCallback, mouse_button, int, int, int);
-CALLBACK_SETUP_N2(glfwSetCursorPosCallback, cursor_pos, double, double);
-CALLBACK_SETUP_N1(glfwSetCursorEnterCallback, cursor_enter, int);
-CALLBACK_SETUP_N2(glfwSetScrollCallback, scroll, double, double);
-CALLBACK_SETUP_N_ary(glfwSetDropCallback, drop, const char**, string);
+/* Appends a cursor sample, overwriting the oldest one when full */
+static void
+window_history_cursor_pos(GLFWwindow *window, double x, double y)
+{
+  mrb_glfw3_window *w = mrb_glfw3_window_data(window);
+  double *sample;
+  if (w->cursor_history.capa == 0) {
+    return;
+  }
+  if (w->cursor_history.len < w->cursor_history.capa) {
+    sample = &w->cursor_history.buf[((w->cursor_history.start + w->cursor_history.len++) % w->cursor_history.capa) * CURSOR_SAMPLE_STRIDE];
+  } else {
+    sample = &w->cursor_history.buf[w->cursor_history.start * CURSOR_SAMPLE_STRIDE];
+    w->cursor_history.start = (w->cursor_history.start + 1) % w->cursor_history.capa;
+  }
+  sample[0] = glfwGetTime();
+  sample[1] = x;
+  sample[2] = y;
+}
+
+#define CALLBACK_DEFINE(_func_, _name_, _sig_, _hook_) \
+  SIG_THUNK_ ## _sig_(_func_, _hook_) \
+  MAKE_MRB_CALLBACK(_name_, _func_, _hook_)
+WINDOW_CALLBACKS(CALLBACK_DEFINE)
+CALLBACK_SETUP_N_ary(drop, const char**, drop_list)
+MAKE_MRB_CALLBACK(glfwSetDropCallback, drop, none)
+
+/* The char callback is written out by hand as it also feeds the native text
+ * buffer, so it stays installed while text input is enabled even without a
+ * block. */
+static void
+text_input_append(mrb_state *mrb, mrb_glfw3_window *w, uint cp)
+{
+  char utf8[4];
+  size_t n;
+  if (cp < 0x80) {
+    utf8[0] = (char)cp;
+    n = 1;
+  } else if (cp < 0x800) {
+    utf8[0] = (char)(0xC0 | (cp >> 6));
+    utf8[1] = (char)(0x80 | (cp & 0x3F));
+    n = 2;
+  } else if (cp < 0x10000) {
+    if (cp >= 0xD800 && cp <= 0xDFFF) {
+      return;
+    }
+    utf8[0] = (char)(0xE0 | (cp >> 12));
+    utf8[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    utf8[2] = (char)(0x80 | (cp & 0x3F));
+    n = 3;
+  } else if (cp < 0x110000) {
+    utf8[0] = (char)(0xF0 | (cp >> 18));
+    utf8[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    utf8[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    utf8[3] = (char)(0x80 | (cp & 0x3F));
+    n = 4;
+  } else {
+    return;
+  }
+  if (w->text.len + n > w->text.capa) {
+    size_t capa = w->text.capa ? w->text.capa * 2 : 64;
+    w->text.buf = mrb_realloc(mrb, w->text.buf, capa);
+    w->text.capa = capa;
+  }
+  memcpy(w->text.buf + w->text.len, utf8, n);
+  w->text.len += n;
+}
+
+static void
+CALLBACK_IDENT(char)(GLFWwindow *window, uint p0)
+{
+  mrb_glfw3_window *w = mrb_glfw3_window_data(window);
+  window_call call;
+  if (w->text.enabled) {
+    text_input_append(cb_MRB, w, p0);
+  }
+  if (event_queue.enabled) {
+    event_queue_push(window, EVENT_TYPE(char))->i[0] = (int)p0;
+    return;
+  }
+  if (!window_call_begin(window, CALLBACK_SLOT(char), 1, &call)) return;
+  if (call.argc > 1) call.argv[1] = to_cast(uint)(cb_MRB, p0);
+  window_call_end(&call);
+}
+
+static void
+window_update_char_callback(mrb_state *mrb, mrb_value self)
+{
+  mrb_glfw3_window *w = get_window_data(mrb, self);
+  if (w->text.enabled || event_queue.enabled || !mrb_nil_p(w->callbacks[CALLBACK_SLOT(char)].blk)) {
+    glfwSetCharCallback(w->handle, CALLBACK_IDENT(char));
+  } else {
+    glfwSetCharCallback(w->handle, NULL);
+  }
+}
+
+static mrb_value
+window_set_char_callback(mrb_state *mrb, mrb_value self)
+{
+  mrb_value blk;
+  mrb_get_args(mrb, "&", &blk);
+  window_store_callback(mrb, self, CALLBACK_SLOT(char), mrb_intern_lit(mrb, CALLBACK_NAME(char)), blk);
+  window_update_char_callback(mrb, self);
+  return blk;
+}
+
+static mrb_value
+INJECT_IDENT(char)(mrb_state *mrb, mrb_value self)
+{
+  mrb_int p0;
+  mrb_get_args(mrb, "i", &p0);
+  CALLBACK_IDENT(char)(get_window(mrb, self), (uint)p0);
+  return self;
+}
+
+static mrb_value
+window_get_text_input(mrb_state *mrb, mrb_value self)
+{
+  return mrb_bool_value(get_window_data(mrb, self)->text.enabled);
+}
+
+static mrb_value
+window_set_text_input(mrb_state *mrb, mrb_value self)
+{
+  mrb_bool enabled;
+  mrb_glfw3_window *w;
+  mrb_get_args(mrb, "b", &enabled);
+  w = get_window_data(mrb, self);
+  w->text.enabled = enabled;
+  if (!enabled) {
+    w->text.len = 0;
+  }
+  window_update_char_callback(mrb, self);
+  return mrb_bool_value(enabled);
+}
+
+/**
+ * Feeds the key and mouse button events of the window to map, even while
+ * they are queued or without a callback block.
+ * @param [GLFW::InputMap, nil] map nil detaches the current one
+ */
+static mrb_value
+window_set_input_map(mrb_state *mrb, mrb_value self)
+{
+  mrb_value map;
+  mrb_glfw3_window *w;
+  mrb_glfw3_input_map *input_map = NULL;
+  mrb_get_args(mrb, "o", &map);
+  w = get_window_data(mrb, self);
+  if (!mrb_nil_p(map)) {
+    input_map = mrb_data_check_get_ptr(mrb, map, &mrb_glfw3_input_map_type);
+    if (!input_map) {
+      mrb_raise(mrb, E_TYPE_ERROR, "expected GLFW::InputMap");
+    }
+  }
+  w->input_map = input_map;
+  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "__input_map"), map);
+  window_sync_callbacks(mrb, self);
+  return map;
+}
+
+static mrb_value
+window_get_input_map(mrb_state *mrb, mrb_value self)
+{
+  return mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "__input_map"));
+}
+
+/**
+ * Records every cursor position natively, with its glfwGetTime timestamp,
+ * in a ring buffer read with Window#take_cursor_history. When full the
+ * oldest samples are overwritten. Pending samples are discarded.
+ * @param [Integer] capacity number of samples kept, 0 disables recording
+ */
+static mrb_value
+window_set_cursor_history(mrb_state *mrb, mrb_value self)
+{
+  mrb_int capacity;
+  mrb_glfw3_window *w;
+  mrb_get_args(mrb, "i", &capacity);
+  if (capacity < 0 || capacity > INT_MAX / CURSOR_SAMPLE_STRIDE) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "invalid cursor history capacity");
+  }
+  w = get_window_data(mrb, self);
+  if (capacity == 0) {
+    if (w->cursor_history.buf) {
+      mrb_free(mrb, w->cursor_history.buf);
+    }
+    w->cursor_history.buf = NULL;
+  } else {
+    w->cursor_history.buf = mrb_realloc(mrb, w->cursor_history.buf, sizeof(double) * CURSOR_SAMPLE_STRIDE * capacity);
+  }
+  w->cursor_history.capa = (int)capacity;
+  w->cursor_history.start = 0;
+  w->cursor_history.len = 0;
+  window_sync_callbacks(mrb, self);
+  return mrb_fixnum_value(capacity);
+}
+
+static mrb_value
+window_get_cursor_history(mrb_state *mrb, mrb_value self)
+{
+  return mrb_fixnum_value(get_window_data(mrb, self)->cursor_history.capa);
+}
+
+/**
+ * Returns the recorded cursor samples, oldest first, and empties the
+ * history.
+ * @return [Array<Float>] flat list of CURSOR_SAMPLE_STRIDE entries per
+ *   sample: time, x, y
+ */
+static mrb_value
+window_take_cursor_history(mrb_state *mrb, mrb_value self)
+{
+  mrb_glfw3_window *w = get_window_data(mrb, self);
+  mrb_value result = mrb_ary_new_capa(mrb, w->cursor_history.len * CURSOR_SAMPLE_STRIDE);
+  int i, j;
+  for (i = 0; i < w->cursor_history.len; ++i) {
+    const double *sample = &w->cursor_history.buf[((w->cursor_history.start + i) % w->cursor_history.capa) * CURSOR_SAMPLE_STRIDE];
+    for (j = 0; j < CURSOR_SAMPLE_STRIDE; ++j) {
+      mrb_ary_push(mrb, result, mrb_float_value(mrb, sample[j]));
+    }
+  }
+  w->cursor_history.start = 0;
+  w->cursor_history.len = 0;
+  return result;
+}
+
+/**
+ * Returns the text typed since the last call as a UTF-8 String, or nil if
+ * there was none. Requires text_input to be enabled.
+ * @return [String, nil]
+ */
+static mrb_value
+window_take_text_input(mrb_state *mrb, mrb_value self)
+{
+  mrb_glfw3_window *w = get_window_data(mrb, self);
+  mrb_value str;
+  if (w->text.len == 0) {
+    return mrb_nil_value();
+  }
+  str = mrb_str_new(mrb, w->text.buf, w->text.len);
+  w->text.len = 0;
+  return str;
+}
+
+#define SYNC_CALLBACK(_func_, _name_, _sig_, _hook_) \
+  _name_(w->handle, CALLBACK_NEEDED(w, _func_, _hook_) ? CALLBACK_IDENT(_func_) : NULL);
+
+/* Installs the C callbacks needed for the current mode: every queued
+ * callback while the event queue is enabled, otherwise only those with a
+ * block or an active hook. */
+static void
+window_sync_callbacks(mrb_state *mrb, mrb_value self)
+{
+  mrb_glfw3_window *w = get_window_data(mrb, self);
+  WINDOW_CALLBACKS(SYNC_CALLBACK)
+  window_update_char_callback(mrb, self);
+}
+
+#define FLOAT_EVENT(_func_, _name_, _sig_, _hook_) \
+    case EVENT_TYPE(_func_): return SIG_FLOAT_ ## _sig_;
+
+/* Whether the arguments of events of type are stored in d */
+static bool
+event_type_float_p(int type)
+{
+  switch (type) {
+    WINDOW_CALLBACKS(FLOAT_EVENT)
+    default: return false;
+  }
+}
+
+#define ARGC_EVENT(_func_, _name_, _sig_, _hook_) \
+    case EVENT_TYPE(_func_): return SIG_ARGC_ ## _sig_;
+
+/* Number of callback arguments, excluding the window, of events of type */
+static int
+event_type_argc(int type)
+{
+  switch (type) {
+    WINDOW_CALLBACKS(ARGC_EVENT)
+    case EVENT_TYPE(char): return 1;
+    default: return 0;
+  }
+}
+
+/**
+ * While enabled, events from every window are recorded natively instead of
+ * being yielded to the window's blocks. Drop events are not queued.
+ * @param [Boolean] enabled
+ */
+static mrb_value
+glfw_s_set_event_queue(mrb_state *mrb, mrb_value klass)
+{
+  mrb_bool enabled;
+  mrb_value objs;
+  mrb_int i;
+  mrb_get_args(mrb, "b", &enabled);
+  event_queue.enabled = enabled;
+  objs = mrb_glfw3_cache(mrb);
+  for (i = 0; i < RARRAY_LEN(objs); ++i) {
+    mrb_value obj = RARRAY_PTR(objs)[i];
+    if (DATA_PTR(obj)) {
+      window_sync_callbacks(mrb, obj);
+    }
+  }
+  if (!enabled) {
+    event_queue.len = 0;
+  }
+  return mrb_bool_value(enabled);
+}
+
+static mrb_value
+glfw_s_get_event_queue(mrb_state *mrb, mrb_value klass)
+{
+  return mrb_bool_value(event_queue.enabled);
+}
+
+static mrb_value
+event_queue_take(mrb_state *mrb)
+{
+  mrb_value str = mrb_str_new(mrb, (const char*)event_queue.buf, sizeof(event_record) * event_queue.len);
+  event_queue.len = 0;
+  return str;
+}
+
+/**
+ * @return [String] the queued events packed as in Window.pack_event, with
+ *   the window id set; the queue is emptied
+ */
+static mrb_value
+glfw_s_take_events(mrb_state *mrb, mrb_value klass)
+{
+  return event_queue_take(mrb);
+}
+
+/**
+ * Yields each queued event as |window, type, *args| and empties the queue,
+ * args being the callback arguments of type. Events of windows destroyed
+ * since, including by the block, are skipped.
+ * @return [Integer] number of events yielded
+ */
+static mrb_value
+glfw_s_each_event(mrb_state *mrb, mrb_value klass)
+{
+  mrb_value blk;
+  mrb_value events;
+  mrb_value registry;
+  mrb_value window = mrb_nil_value();
+  int window_id = 0;
+  mrb_int count = 0;
+  mrb_int len;
+  mrb_int i;
+  int j;
+  mrb_get_args(mrb, "&", &blk);
+  if (mrb_nil_p(blk)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "no block given");
+  }
+  events = event_queue_take(mrb);
+  registry = mrb_glfw3_window_registry(mrb);
+  len = RSTRING_LEN(events) / sizeof(event_record);
+  for (i = 0; i < len; ++i) {
+    event_record ev;
+    mrb_value argv[6];
+    int argc;
+    int ai;
+    memcpy(&ev, RSTRING_PTR(events) + i * sizeof(event_record), sizeof(ev));
+    if (ev.window != window_id) {
+      window_id = ev.window;
+      window = mrb_hash_fetch(mrb, registry, mrb_fixnum_value(window_id), mrb_nil_value());
+    }
+    /* checked per event, the block may destroy the window */
+    if (mrb_nil_p(window) || !DATA_PTR(window)) {
+      continue;
+    }
+    ai = mrb_gc_arena_save(mrb);
+    argv[0] = window;
+    argv[1] = mrb_fixnum_value(ev.type);
+    argc = 2 + event_type_argc(ev.type);
+    for (j = 2; j < argc; ++j) {
+      argv[j] = event_type_float_p(ev.type) ?
+        mrb_float_value(mrb, ev.d[j - 2]) : mrb_fixnum_value(ev.i[j - 2]);
+    }
+    mrb_yield_argv(mrb, blk, argc, argv);
+    mrb_gc_arena_restore(mrb, ai);
+    ++count;
+  }
+  return mrb_fixnum_value(count);
+}
+
+static mrb_value
+window_get_id(mrb_state *mrb, mrb_value self)
+{
+  return mrb_fixnum_value(get_window_data(mrb, self)->id);
+}
+
+/**
+ * Queries every live window in a single pass.
+ * @return [Array] flat list of WINDOW_STATE_STRIDE entries per window:
+ *   window, should_close, focused, iconified, framebuffer width and height
+ */
+static mrb_value
+glfw_s_windows_state(mrb_state *mrb, mrb_value klass)
+{
+  mrb_value objs = mrb_glfw3_cache(mrb);
+  mrb_value result = mrb_ary_new_capa(mrb, RARRAY_LEN(objs) * WINDOW_STATE_STRIDE);
+  mrb_int i;
+  for (i = 0; i < RARRAY_LEN(objs); ++i) {
+    mrb_value obj = RARRAY_PTR(objs)[i];
+    mrb_glfw3_window *w = DATA_PTR(obj);
+    int width, height;
+    if (!w) {
+      continue;
+    }
+    glfwGetFramebufferSize(w->handle, &width, &height);
+    mrb_ary_push(mrb, result, obj);
+    mrb_ary_push(mrb, result, mrb_bool_value(glfwWindowShouldClose(w->handle)));
+    mrb_ary_push(mrb, result, mrb_bool_value(glfwGetWindowAttrib(w->handle, GLFW_FOCUSED)));
+    mrb_ary_push(mrb, result, mrb_bool_value(glfwGetWindowAttrib(w->handle, GLFW_ICONIFIED)));
+    mrb_ary_push(mrb, result, mrb_fixnum_value(width));
+    mrb_ary_push(mrb, result, mrb_fixnum_value(height));
+  }
+  return result;
+}
+
+#define CLEAR_CALLBACK(_func_, _name_, _sig_, _hook_) \
+  _name_(w->handle, NULL); \
+  window_store_callback(mrb, self, CALLBACK_SLOT(_func_), mrb_intern_lit(mrb, CALLBACK_NAME(_func_)), mrb_nil_value());
+
+/**
+ * Removes every callback and disables text input, used to recycle windows.
+ */
+static mrb_value
+window_clear_callbacks(mrb_state *mrb, mrb_value self)
+{
+  mrb_glfw3_window *w = get_window_data(mrb, self);
+  WINDOW_CALLBACKS(CLEAR_CALLBACK)
+  CLEAR_CALLBACK(char, glfwSetCharCallback, _, none)
+  CLEAR_CALLBACK(drop, glfwSetDropCallback, _, none)
+  w->text.enabled = false;
+  w->text.len = 0;
+  w->input_map = NULL;
+  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "__input_map"), mrb_nil_value());
+  if (w->cursor_history.buf) {
+    mrb_free(mrb, w->cursor_history.buf);
+    w->cursor_history.buf = NULL;
+  }
+  w->cursor_history.capa = 0;
+  w->cursor_history.start = 0;
+  w->cursor_history.len = 0;
+  if (event_queue.enabled) {
+    window_sync_callbacks(mrb, self);
+  }
+  return self;
+}
+
+static mrb_value
+window_destroyed_p(mrb_state *mrb, mrb_value self)
+{
+  return mrb_bool_value(DATA_PTR(self) == NULL);
+}
+
+#define DISPATCH_CALLBACK(_func_, _name_, _sig_, _hook_) \
+    case EVENT_TYPE(_func_): SIG_DISPATCH_ ## _sig_(_func_); break;
+
+static void
+window_dispatch_event(GLFWwindow *window, const event_record *ev)
+{
+  switch (ev->type) {
+    WINDOW_CALLBACKS(DISPATCH_CALLBACK)
+    case EVENT_TYPE(char): CALLBACK_IDENT(char)(window, (uint)ev->i[0]); break;
+    default: break;
+  }
+}
+
+/**
+ * Packs a single event into a String suitable for Window#inject_events
+ * @param [Integer] type one of the Window::EVENT_* constants
+ * @param [Numeric] args the callback arguments, excluding the window
+ * @return [String]
+ */
+static mrb_value
+window_s_pack_event(mrb_state *mrb, mrb_value klass)
+{
+  mrb_int type;
+  mrb_value *args;
+  mrb_int argc;
+  mrb_int i;
+  event_record ev;
+  mrb_get_args(mrb, "i*", &type, &args, &argc);
+  if (argc > 4) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "too many event arguments");
+  }
+  memset(&ev, 0, sizeof(ev));
+  ev.type = (int)type;
+  for (i = 0; i < argc; ++i) {
+    if (event_type_float_p((int)type)) {
+      if (i < 2) {
+        ev.d[i] = mrb_to_flo(mrb, args[i]);
+      }
+    } else {
+      ev.i[i] = (int)mrb_int(mrb, args[i]);
+    }
+  }
+  return mrb_str_new(mrb, (const char*)&ev, sizeof(ev));
+}
+
+/**
+ * Dispatches a String of packed events (see Window.pack_event) through the
+ * window's callbacks, as if they had been received from GLFW.
+ * @param [String] events
+ */
+static mrb_value
+window_inject_events(mrb_state *mrb, mrb_value self)
+{
+  char *data;
+  mrb_int len;
+  mrb_int i;
+  event_record ev;
+  GLFWwindow *window;
+  mrb_get_args(mrb, "s", &data, &len);
+  if (len % sizeof(event_record) != 0) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "events String is not a multiple of the event record size");
+  }
+  window = get_window(mrb, self);
+  for (i = 0; i < len; i += sizeof(event_record)) {
+    /* copied out as the String is not guaranteed to be aligned */
+    memcpy(&ev, data + i, sizeof(ev));
+    window_dispatch_event(window, &ev);
+  }
+  return self;
+}
+
+static const mrb_glfw3_const window_constants[] = {
+  MRB_GLFW3_CONST("EVENT_POS", EVENT_TYPE(pos)),
+  MRB_GLFW3_CONST("EVENT_SIZE", EVENT_TYPE(size)),
+  MRB_GLFW3_CONST("EVENT_CLOSE", EVENT_TYPE(close)),
+  MRB_GLFW3_CONST("EVENT_REFRESH", EVENT_TYPE(refresh)),
+  MRB_GLFW3_CONST("EVENT_FOCUS", EVENT_TYPE(focus)),
+  MRB_GLFW3_CONST("EVENT_ICONIFY", EVENT_TYPE(iconify)),
+  MRB_GLFW3_CONST("EVENT_FRAMEBUFFER_SIZE", EVENT_TYPE(framebuffer_size)),
+  MRB_GLFW3_CONST("EVENT_KEY", EVENT_TYPE(key)),
+  MRB_GLFW3_CONST("EVENT_CHAR", EVENT_TYPE(char)),
+  MRB_GLFW3_CONST("EVENT_CHAR_MODS", EVENT_TYPE(char_mods)),
+  MRB_GLFW3_CONST("EVENT_MOUSE_BUTTON", EVENT_TYPE(mouse_button)),
+  MRB_GLFW3_CONST("EVENT_CURSOR_POS", EVENT_TYPE(cursor_pos)),
+  MRB_GLFW3_CONST("EVENT_CURSOR_ENTER", EVENT_TYPE(cursor_enter)),
+  MRB_GLFW3_CONST("EVENT_SCROLL", EVENT_TYPE(scroll)),
+#if MRB_GLFW3_VERSION_AT_LEAST(3, 3)
+  MRB_GLFW3_CONST("EVENT_MAXIMIZE", EVENT_TYPE(maximize)),
+  MRB_GLFW3_CONST("EVENT_CONTENT_SCALE", EVENT_TYPE(content_scale)),
+#endif
+  MRB_GLFW3_CONST("CURSOR_SAMPLE_STRIDE", CURSOR_SAMPLE_STRIDE),
+};
+
+/* defined on GLFW itself, next to GLFW.windows_state */
+static const mrb_glfw3_const window_module_constants[] = {
+  MRB_GLFW3_CONST("WINDOW_STATE_STRIDE", WINDOW_STATE_STRIDE),
+};
+
+#define DEFINE_CALLBACK_METHODS(_func_, _name_, _sig_, _hook_) \
+  mrb_define_method(mrb, mrb_glfw3_window_class, "set_" #_func_ "_callback", window_set_ ## _func_ ## _callback, MRB_ARGS_BLOCK()); \
+  mrb_define_method(mrb, mrb_glfw3_window_class, "inject_" #_func_, INJECT_IDENT(_func_), MRB_ARGS_REQ(SIG_ARGC_ ## _sig_));
 
 void
 mrb_glfw3_window_init(mrb_state* mrb, struct RClass *mod)
 {
   cb_MRB = mrb;
+  mrb_define_class_method(mrb, mod, "event_queue=", glfw_s_set_event_queue, MRB_ARGS_REQ(1));
+  mrb_define_class_method(mrb, mod, "event_queue?", glfw_s_get_event_queue, MRB_ARGS_NONE());
+  mrb_define_class_method(mrb, mod, "take_events",  glfw_s_take_events,     MRB_ARGS_NONE());
+  mrb_define_class_method(mrb, mod, "each_event",   glfw_s_each_event,      MRB_ARGS_BLOCK());
+  mrb_define_class_method(mrb, mod, "windows_state", glfw_s_windows_state,  MRB_ARGS_NONE());
+  mrb_glfw3_define_consts(mrb, mod, window_module_constants, MRB_GLFW3_CONST_COUNT(window_module_constants));
+
   mrb_glfw3_window_class = mrb_define_class_under(mrb, mod, "Window", mrb->object_class);
   MRB_SET_INSTANCE_TT(mrb_glfw3_window_class, MRB_TT_DATA);
-  mrb_define_method(mrb, mrb_glfw3_window_class, "initialize",        window_initialize,        MRB_ARGS_REQ(3) | MRB_ARGS_OPT(2));
+  mrb_define_method(mrb, mrb_glfw3_window_class, "initialize",        window_initialize,        MRB_ARGS_REQ(3) | MRB_ARGS_OPT(3));
   mrb_define_method(mrb, mrb_glfw3_window_class, "destroy",           window_destroy,           MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_glfw3_window_class, "destroyed?",        window_destroyed_p,       MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_glfw3_window_class, "id",                window_get_id,            MRB_ARGS_NONE());
   mrb_define_method(mrb, mrb_glfw3_window_class, "should_close",      window_get_should_close,  MRB_ARGS_NONE());
   mrb_define_method(mrb, mrb_glfw3_window_class, "should_close?",     window_get_should_close,  MRB_ARGS_NONE());
   mrb_define_method(mrb, mrb_glfw3_window_class, "should_close=",     window_set_should_close,  MRB_ARGS_REQ(1));
@@ -427,28 +1439,35 @@ mrb_glfw3_window_init(mrb_state* mrb, struct RClass *mod)
   mrb_define_method(mrb, mrb_glfw3_window_class, "show",              window_show,              MRB_ARGS_NONE());
   mrb_define_method(mrb, mrb_glfw3_window_class, "hide",              window_hide,              MRB_ARGS_NONE());
   mrb_define_method(mrb, mrb_glfw3_window_class, "monitor",           window_get_monitor,       MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_glfw3_window_class, "set_monitor",       window_set_monitor,       MRB_ARGS_ARG(5, 1));
   mrb_define_method(mrb, mrb_glfw3_window_class, "clipboard",         window_get_clipboard,     MRB_ARGS_NONE());
   mrb_define_method(mrb, mrb_glfw3_window_class, "clipboard=",        window_set_clipboard,     MRB_ARGS_REQ(1));
   mrb_define_method(mrb, mrb_glfw3_window_class, "window_attrib",     window_get_window_attrib, MRB_ARGS_REQ(1));
   mrb_define_method(mrb, mrb_glfw3_window_class, "make_current",      window_make_current,      MRB_ARGS_NONE());
   mrb_define_method(mrb, mrb_glfw3_window_class, "swap_buffers",      window_swap_buffers,      MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_glfw3_window_class, "proc_table",        window_get_proc_table,    MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_glfw3_window_class, "icon=",             window_set_icon,          MRB_ARGS_REQ(1));
   mrb_define_method(mrb, mrb_glfw3_window_class, "get_input_mode",    window_get_input_mode,    MRB_ARGS_REQ(1));
   mrb_define_method(mrb, mrb_glfw3_window_class, "set_input_mode",    window_set_input_mode,    MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, mrb_glfw3_window_class, "text_input?",       window_get_text_input,    MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_glfw3_window_class, "text_input=",       window_set_text_input,    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, mrb_glfw3_window_class, "take_text_input",   window_take_text_input,   MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_glfw3_window_class, "input_map",         window_get_input_map,     MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_glfw3_window_class, "input_map=",        window_set_input_map,     MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, mrb_glfw3_window_class, "cursor_history",    window_get_cursor_history, MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_glfw3_window_class, "cursor_history=",   window_set_cursor_history, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, mrb_glfw3_window_class, "take_cursor_history", window_take_cursor_history, MRB_ARGS_NONE());
 
   /* Callbacks */
-  mrb_define_method(mrb, mrb_glfw3_window_class, "set_pos_callback",              window_set_pos_callback,              MRB_ARGS_BLOCK());
-  mrb_define_method(mrb, mrb_glfw3_window_class, "set_size_callback",             window_set_size_callback,             MRB_ARGS_BLOCK());
-  mrb_define_method(mrb, mrb_glfw3_window_class, "set_close_callback",            window_set_close_callback,            MRB_ARGS_BLOCK());
-  mrb_define_method(mrb, mrb_glfw3_window_class, "set_refresh_callback",          window_set_refresh_callback,          MRB_ARGS_BLOCK());
-  mrb_define_method(mrb, mrb_glfw3_window_class, "set_focus_callback",            window_set_focus_callback,            MRB_ARGS_BLOCK());
-  mrb_define_method(mrb, mrb_glfw3_window_class, "set_iconify_callback",          window_set_iconify_callback,          MRB_ARGS_BLOCK());
-  mrb_define_method(mrb, mrb_glfw3_window_class, "set_framebuffer_size_callback", window_set_framebuffer_size_callback, MRB_ARGS_BLOCK());
-  mrb_define_method(mrb, mrb_glfw3_window_class, "set_key_callback",              window_set_key_callback,              MRB_ARGS_BLOCK());
+  WINDOW_CALLBACKS(DEFINE_CALLBACK_METHODS)
   mrb_define_method(mrb, mrb_glfw3_window_class, "set_char_callback",             window_set_char_callback,             MRB_ARGS_BLOCK());
-  mrb_define_method(mrb, mrb_glfw3_window_class, "set_char_mods_callback",        window_set_char_mods_callback,        MRB_ARGS_BLOCK());
-  mrb_define_method(mrb, mrb_glfw3_window_class, "set_mouse_button_callback",     window_set_mouse_button_callback,     MRB_ARGS_BLOCK());
-  mrb_define_method(mrb, mrb_glfw3_window_class, "set_cursor_pos_callback",       window_set_cursor_pos_callback,       MRB_ARGS_BLOCK());
-  mrb_define_method(mrb, mrb_glfw3_window_class, "set_cursor_enter_callback",     window_set_cursor_enter_callback,     MRB_ARGS_BLOCK());
-  mrb_define_method(mrb, mrb_glfw3_window_class, "set_scroll_callback",           window_set_scroll_callback,           MRB_ARGS_BLOCK());
   mrb_define_method(mrb, mrb_glfw3_window_class, "set_drop_callback",             window_set_drop_callback,             MRB_ARGS_BLOCK());
+  mrb_define_method(mrb, mrb_glfw3_window_class, "clear_callbacks",               window_clear_callbacks,               MRB_ARGS_NONE());
+
+  /* Synthetic events */
+  mrb_define_method(mrb, mrb_glfw3_window_class, "inject_char",             window_inject_char,             MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, mrb_glfw3_window_class, "inject_drop",             window_inject_drop,             MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, mrb_glfw3_window_class, "inject_events",           window_inject_events,           MRB_ARGS_REQ(1));
+  mrb_define_class_method(mrb, mrb_glfw3_window_class, "pack_event",        window_s_pack_event,            MRB_ARGS_REQ(1) | MRB_ARGS_REST());
+  mrb_glfw3_define_consts(mrb, mrb_glfw3_window_class, window_constants, MRB_GLFW3_CONST_COUNT(window_constants));
 }
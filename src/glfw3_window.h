@@ -1,11 +1,58 @@
 #ifndef MRB_GLFW3_WINDOW_H
 #define MRB_GLFW3_WINDOW_H
 
+#include <stdbool.h>
+
 #include <mruby.h>
 #include <mruby/data.h>
 #include <mruby/class.h>
 
+#include <GLFW/glfw3.h>
+
+/* Native state kept alongside each GLFW::Window */
+typedef struct mrb_glfw3_window
+{
+  GLFWwindow *handle;
+  /* unique per window, tags events in the shared event queue */
+  int id;
+  /* UTF-8 text accumulated from char events, see Window#take_text_input */
+  struct {
+    bool enabled;
+    char *buf;
+    size_t len;
+    size_t capa;
+  } text;
+  /* Support bits for the tracked extensions, see glfw3_extensions.c */
+  struct {
+    unsigned int *bits;
+    mrb_int count;
+    int generation;
+  } extensions;
+  /* Blocks of the window callbacks, see WINDOW_CALLBACKS in glfw3_window.c */
+  struct mrb_glfw3_window_callback *callbacks;
+  /* fed by the key and mouse button callbacks, see Window#input_map= */
+  struct mrb_glfw3_input_map *input_map;
+  /* ring buffer of time, x, y cursor samples, see Window#cursor_history= */
+  struct {
+    double *buf;
+    int capa;
+    int start;
+    int len;
+  } cursor_history;
+  /* GL state for Window#read_framebuffer, see glfw3_readback.c */
+  struct mrb_glfw3_readback *readback;
+} mrb_glfw3_window;
+
 extern const struct mrb_data_type mrb_glfw3_window_type;
+void mrb_glfw3_window_free(mrb_state *mrb, void *ptr);
 void mrb_glfw3_window_init(mrb_state *mrb, struct RClass *mod);
+void mrb_glfw3_event_queue_reset(mrb_state *mrb);
+
+/* Returns the native state of a window created through GLFW::Window */
+static inline mrb_glfw3_window*
+mrb_glfw3_window_data(GLFWwindow *window)
+{
+  return (mrb_glfw3_window*)DATA_PTR(mrb_obj_value(glfwGetWindowUserPointer(window)));
+}
 
 #endif
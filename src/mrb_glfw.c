@@ -1,33 +1,240 @@
 #include <stdbool.h>
+#include <stdint.h>
 
 #include <mruby.h>
 #include <mruby/class.h>
 #include <mruby/variable.h>
 #include <mruby/array.h>
 #include <mruby/error.h>
+#include <mruby/hash.h>
 
 #include "glfw3_private.h"
 #include "glfw3_cursor.h"
+#include "glfw3_drop_list.h"
+#include "glfw3_extensions.h"
 #include "glfw3_gamma_ramp.h"
+#include "glfw3_hint_set.h"
 #include "glfw3_image.h"
+#include "glfw3_input_map.h"
 #include "glfw3_monitor.h"
+#include "glfw3_proc_table.h"
+#include "glfw3_readback.h"
 #include "glfw3_vid_mode.h"
 #include "glfw3_window.h"
 
 /* Needed for callbacks to work correctly */
 static mrb_state *glfw_mrb_state = NULL;
+static bool glfw_initialized = false;
+
+/* One bit per joystick slot, kept up to date by the joystick callback which
+ * stays installed while GLFW is initialized. The block given to
+ * GLFW.set_joystick_callback is mirrored from its ivar. */
+static struct {
+  uint32_t connected;
+  mrb_value callback;
+} glfw_joysticks;
+
+/* Headless settings requested through GLFW.init, these are re-applied
+ * whenever the window hints are reset. */
+static struct {
+  bool enabled;
+  int context_api;
+  int client_api; /* -1 keeps the GLFW default */
+} glfw_headless = { false, 0, -1 };
+
+#if MRB_GLFW3_VERSION_AT_LEAST(3, 4)
+static const mrb_glfw3_sym_map glfw_platform_map[] = {
+  { "any",     GLFW_ANY_PLATFORM },
+  { "null",    GLFW_PLATFORM_NULL },
+  { "x11",     GLFW_PLATFORM_X11 },
+  { "wayland", GLFW_PLATFORM_WAYLAND },
+  { "win32",   GLFW_PLATFORM_WIN32 },
+  { "cocoa",   GLFW_PLATFORM_COCOA },
+  { NULL, 0 }
+};
+#endif
+
+static const mrb_glfw3_sym_map glfw_context_api_map[] = {
+  { "native", GLFW_NATIVE_CONTEXT_API },
+  { "egl",    GLFW_EGL_CONTEXT_API },
+#if MRB_GLFW3_VERSION_AT_LEAST(3, 3)
+  { "osmesa", GLFW_OSMESA_CONTEXT_API },
+#endif
+  { NULL, 0 }
+};
+
+static const mrb_glfw3_sym_map glfw_client_api_map[] = {
+  { "opengl",    GLFW_OPENGL_API },
+  { "opengl_es", GLFW_OPENGL_ES_API },
+  { "none",      GLFW_NO_API },
+  { NULL, 0 }
+};
+
+static void
+glfw_apply_headless_hints(void)
+{
+  if (glfw_headless.enabled) {
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+    if (glfw_headless.context_api) {
+      glfwWindowHint(GLFW_CONTEXT_CREATION_API, glfw_headless.context_api);
+    }
+  }
+  if (glfw_headless.client_api >= 0) {
+    glfwWindowHint(GLFW_CLIENT_API, glfw_headless.client_api);
+  }
+}
 
 static mrb_value
-glfw_init(mrb_state* mrb, mrb_value self)
+glfw_opt_get(mrb_state *mrb, mrb_value hash, const char *key)
+{
+  return mrb_hash_get(mrb, hash, mrb_symbol_value(mrb_intern_cstr(mrb, key)));
+}
+
+/**
+ * Handles the options Hash given to GLFW.init
+ *   platform:    (GLFW 3.4) :any, :null, :x11, :wayland, :win32 or :cocoa
+ *   headless:    create hidden windows by default, implied by platform: :null
+ *   context_api: :native, :egl or (GLFW 3.3) :osmesa
+ *   client_api:  :opengl, :opengl_es or :none for windows without a
+ *                context, which the null platform can create without OSMesa
+ */
+static void
+glfw_init_options(mrb_state *mrb, mrb_value opts)
+{
+  mrb_value platform = glfw_opt_get(mrb, opts, "platform");
+  mrb_value headless = glfw_opt_get(mrb, opts, "headless");
+  mrb_value context_api = glfw_opt_get(mrb, opts, "context_api");
+  mrb_value client_api = glfw_opt_get(mrb, opts, "client_api");
+  glfw_headless.enabled = false;
+  glfw_headless.context_api = 0;
+  glfw_headless.client_api = -1;
+  if (!mrb_nil_p(platform)) {
+#if MRB_GLFW3_VERSION_AT_LEAST(3, 4)
+    int value = mrb_glfw3_sym_map_lookup(mrb, glfw_platform_map, platform, "platform");
+    glfwInitHint(GLFW_PLATFORM, value);
+    glfw_headless.enabled = (value == GLFW_PLATFORM_NULL);
+#else
+    mrb_raise(mrb, E_NOTIMP_ERROR, "platform selection requires GLFW 3.4");
+#endif
+  }
+  if (!mrb_nil_p(headless)) {
+    glfw_headless.enabled = mrb_test(headless);
+  }
+  if (!mrb_nil_p(context_api)) {
+    glfw_headless.context_api = mrb_glfw3_sym_map_lookup(mrb, glfw_context_api_map, context_api, "context_api");
+  }
+  if (!mrb_nil_p(client_api)) {
+    glfw_headless.client_api = mrb_glfw3_sym_map_lookup(mrb, glfw_client_api_map, client_api, "client_api");
+  }
+}
+
+static void
+glfw_joystick_callback_handler(int joy, int event)
+{
+  mrb_value argv[2];
+  if (event == GLFW_CONNECTED) {
+    glfw_joysticks.connected |= UINT32_C(1) << joy;
+  } else if (event == GLFW_DISCONNECTED) {
+    glfw_joysticks.connected &= ~(UINT32_C(1) << joy);
+  }
+  if (mrb_nil_p(glfw_joysticks.callback)) {
+    return;
+  }
+  argv[0] = mrb_fixnum_value(joy);
+  argv[1] = mrb_fixnum_value(event);
+  mrb_yield_argv(glfw_mrb_state, glfw_joysticks.callback, 2, argv);
+}
+
+/* Scans the slots once, the callback keeps the mask current afterwards */
+static void
+glfw_joysticks_install(void)
 {
-  int err;
-  err = glfwInit();
-  if (err != GL_TRUE) {
+  int joy;
+  glfw_joysticks.connected = 0;
+  for (joy = GLFW_JOYSTICK_1; joy <= GLFW_JOYSTICK_LAST; ++joy) {
+    if (glfwJoystickPresent(joy)) {
+      glfw_joysticks.connected |= UINT32_C(1) << joy;
+    }
+  }
+  glfwSetJoystickCallback(glfw_joystick_callback_handler);
+}
+
+static void
+glfw_init_m(mrb_state* mrb)
+{
+  if (glfwInit() != GL_TRUE) {
     mrb_raise(mrb, E_GLFW_ERROR, "GLFW initialization failed.");
   }
+  glfw_initialized = true;
+  glfw_apply_headless_hints();
+  mrb_glfw3_monitor_install(mrb);
+  glfw_joysticks_install();
+}
+
+/* GLFW is initialized on first use, with the options of the last
+ * GLFW.init call if any, so scripts that never open a window or query a
+ * device never pay for glfwInit. */
+void
+mrb_glfw3_ensure_init(mrb_state* mrb)
+{
+  if (!glfw_initialized) {
+    glfw_init_m(mrb);
+  }
+}
+
+/**
+ * Optional, GLFW is initialized implicitly on first use.
+ * @param [Hash] opts optional, see glfw_init_options
+ */
+static mrb_value
+glfw_init(mrb_state* mrb, mrb_value self)
+{
+  mrb_value opts = mrb_nil_value();
+  mrb_get_args(mrb, "|H", &opts);
+  if (!mrb_nil_p(opts)) {
+    glfw_init_options(mrb, opts);
+  }
+  glfw_init_m(mrb);
   return mrb_bool_value(true);
 }
 
+static mrb_value
+glfw_initialized_p(mrb_state* mrb, mrb_value self)
+{
+  return mrb_bool_value(glfw_initialized);
+}
+
+static mrb_value
+glfw_init_hint(mrb_state* mrb, mrb_value self)
+{
+  mrb_int hint, value;
+  mrb_get_args(mrb, "ii", &hint, &value);
+#if MRB_GLFW3_VERSION_AT_LEAST(3, 3)
+  glfwInitHint(hint, value);
+#else
+  mrb_raise(mrb, E_NOTIMP_ERROR, "init hints require GLFW 3.3");
+#endif
+  return self;
+}
+
+static mrb_value
+glfw_platform_supported_p(mrb_state* mrb, mrb_value self)
+{
+  mrb_value platform;
+  mrb_get_args(mrb, "o", &platform);
+#if MRB_GLFW3_VERSION_AT_LEAST(3, 4)
+  return mrb_bool_value(glfwPlatformSupported(mrb_glfw3_sym_map_lookup(mrb, glfw_platform_map, platform, "platform")) == GL_TRUE);
+#else
+  return mrb_false_value();
+#endif
+}
+
+static mrb_value
+glfw_headless_p(mrb_state* mrb, mrb_value self)
+{
+  return mrb_bool_value(glfw_headless.enabled);
+}
+
 static void
 glfw_terminate_m(mrb_state* mrb)
 {
@@ -36,7 +243,7 @@ glfw_terminate_m(mrb_state* mrb)
     mrb_value const obj = RARRAY_PTR(objs)[i];
     if (DATA_TYPE(obj) == &mrb_glfw3_window_type) {
       if (DATA_PTR(obj)) {
-        glfwDestroyWindow((GLFWwindow*)DATA_PTR(obj));
+        mrb_glfw3_window_free(mrb, DATA_PTR(obj));
         DATA_PTR(obj) = NULL;
         DATA_TYPE(obj) = NULL;
       }
@@ -44,7 +251,14 @@ glfw_terminate_m(mrb_state* mrb)
       mrb_assert(false);
     }
   }
-  glfwTerminate();
+  mrb_glfw3_event_queue_reset(mrb);
+  mrb_glfw3_cursor_reset(mrb);
+  mrb_glfw3_monitor_reset(mrb);
+  glfw_joysticks.connected = 0;
+  if (glfw_initialized) {
+    glfwTerminate();
+    glfw_initialized = false;
+  }
 }
 
 static mrb_value
@@ -52,6 +266,7 @@ glfw_terminate(mrb_state* mrb, mrb_value klass)
 {
   glfw_terminate_m(mrb);
   mrb_ary_clear(mrb, mrb_glfw3_cache(mrb));
+  mrb_hash_clear(mrb, mrb_glfw3_window_registry(mrb));
   return mrb_nil_value();
 }
 
@@ -95,14 +310,6 @@ glfw_proc_address(mrb_state* mrb, mrb_value self)
   return mrb_cptr_value(mrb, (void*)glfwGetProcAddress(str));
 }
 
-static mrb_value
-glfw_extension_supported_p(mrb_state *M, mrb_value self)
-{
-  char *str;
-  mrb_get_args(M, "z", &str);
-  return mrb_bool_value(glfwExtensionSupported(str) != GL_FALSE);
-}
-
 static mrb_value
 glfw_version(mrb_state *M, mrb_value self)
 {
@@ -152,10 +359,18 @@ glfw_wait_events(mrb_state *M, mrb_value self)
   return self;
 }
 
+void
+mrb_glfw3_default_window_hints(void)
+{
+  glfwDefaultWindowHints();
+  glfw_apply_headless_hints();
+}
+
 static mrb_value
 glfw_default_window_hints(mrb_state *M, mrb_value self)
 {
-  glfwDefaultWindowHints();
+  mrb_glfw3_ensure_init(M);
+  mrb_glfw3_default_window_hints();
   return self;
 }
 
@@ -164,6 +379,7 @@ glfw_window_hint(mrb_state* mrb, mrb_value self)
 {
   mrb_int target, hint;
   mrb_get_args(mrb, "ii", &target, &hint);
+  mrb_glfw3_ensure_init(mrb);
   glfwWindowHint(target, hint);
   return self;
 }
@@ -180,7 +396,22 @@ glfw_joystick_present(mrb_state* mrb, mrb_value self)
 {
   mrb_int joy;
   mrb_get_args(mrb, "i", &joy);
-  return mrb_fixnum_value(glfwJoystickPresent(joy));
+  mrb_glfw3_ensure_init(mrb);
+  if (joy < GLFW_JOYSTICK_1 || joy > GLFW_JOYSTICK_LAST) {
+    return mrb_fixnum_value(glfwJoystickPresent(joy));
+  }
+  return mrb_fixnum_value((glfw_joysticks.connected >> joy) & 1 ? GL_TRUE : GL_FALSE);
+}
+
+/**
+ * @return [Integer] mask of the connected joysticks, bit n set when
+ *   joystick n is present
+ */
+static mrb_value
+glfw_connected_joysticks(mrb_state* mrb, mrb_value self)
+{
+  mrb_glfw3_ensure_init(mrb);
+  return mrb_fixnum_value(glfw_joysticks.connected);
 }
 
 static mrb_value
@@ -192,6 +423,7 @@ glfw_joystick_axes(mrb_state* mrb, mrb_value self)
   const float *axes;
   mrb_value result;
   mrb_get_args(mrb, "i", &joy);
+  mrb_glfw3_ensure_init(mrb);
   axes = glfwGetJoystickAxes(joy, &count);
   result = mrb_ary_new(mrb);
   for (i = 0; i < count; ++i) {
@@ -209,6 +441,7 @@ glfw_joystick_buttons(mrb_state* mrb, mrb_value self)
   const unsigned char *buttons;
   mrb_value result;
   mrb_get_args(mrb, "i", &joy);
+  mrb_glfw3_ensure_init(mrb);
   buttons = glfwGetJoystickButtons(joy, &count);
   result = mrb_ary_new(mrb);
   for (i = 0; i < count; ++i) {
@@ -223,19 +456,11 @@ glfw_joystick_name(mrb_state* mrb, mrb_value self)
   mrb_int joy;
   const char *name;
   mrb_get_args(mrb, "i", &joy);
+  mrb_glfw3_ensure_init(mrb);
   name = glfwGetJoystickName(joy);
   return mrb_str_new_cstr(mrb, name);
 }
 
-static void
-glfw_joystick_callback_handler(int joy, int event)
-{
-  struct RClass *glfw_module = mrb_module_get(glfw_mrb_state, "GLFW");
-  mrb_value cb = mrb_iv_get(glfw_mrb_state, mrb_obj_value(glfw_module), mrb_intern_lit(glfw_mrb_state, "cb_joystick"));
-  mrb_value argv[] = { mrb_fixnum_value(joy), mrb_fixnum_value(event) };
-  mrb_yield_argv(glfw_mrb_state, cb, 2, argv);
-}
-
 static mrb_value
 glfw_set_joystick_callback(mrb_state* mrb, mrb_value self)
 {
@@ -249,13 +474,10 @@ glfw_set_joystick_callback(mrb_state* mrb, mrb_value self)
   } else {
     cb = obj;
   }
+  mrb_glfw3_ensure_init(mrb);
   glfw_module = mrb_module_get(mrb, "GLFW");
   mrb_iv_set(mrb, mrb_obj_value(glfw_module), mrb_intern_lit(mrb, "cb_joystick"), cb);
-  if (mrb_nil_p(cb)) {
-    glfwSetJoystickCallback(NULL);
-  } else {
-    glfwSetJoystickCallback(glfw_joystick_callback_handler);
-  }
+  glfw_joysticks.callback = cb;
   return self;
 }
 
@@ -265,20 +487,274 @@ glfw_cache_size(mrb_state* mrb, mrb_value self)
   return mrb_fixnum_value(RARRAY_LEN(mrb_glfw3_cache(mrb)));
 }
 
+/* GLFW module constants, defined in one pass by mrb_mruby_glfw3_gem_init */
+static const mrb_glfw3_const glfw_constants[] = {
+  MRB_GLFW3_CONST("VERSION_MAJOR", GLFW_VERSION_MAJOR),
+  MRB_GLFW3_CONST("VERSION_MINOR", GLFW_VERSION_MINOR),
+  MRB_GLFW3_CONST("VERSION_REVISION", GLFW_VERSION_REVISION),
+  MRB_GLFW3_CONST("RELEASE", GLFW_RELEASE),
+  MRB_GLFW3_CONST("PRESS", GLFW_PRESS),
+  MRB_GLFW3_CONST("REPEAT", GLFW_REPEAT),
+  MRB_GLFW3_CONST("KEY_UNKNOWN", GLFW_KEY_UNKNOWN),
+  MRB_GLFW3_CONST("KEY_SPACE", GLFW_KEY_SPACE),
+  MRB_GLFW3_CONST("KEY_APOSTROPHE", GLFW_KEY_APOSTROPHE),
+  MRB_GLFW3_CONST("KEY_COMMA", GLFW_KEY_COMMA),
+  MRB_GLFW3_CONST("KEY_MINUS", GLFW_KEY_MINUS),
+  MRB_GLFW3_CONST("KEY_PERIOD", GLFW_KEY_PERIOD),
+  MRB_GLFW3_CONST("KEY_SLASH", GLFW_KEY_SLASH),
+  MRB_GLFW3_CONST("KEY_0", GLFW_KEY_0),
+  MRB_GLFW3_CONST("KEY_1", GLFW_KEY_1),
+  MRB_GLFW3_CONST("KEY_2", GLFW_KEY_2),
+  MRB_GLFW3_CONST("KEY_3", GLFW_KEY_3),
+  MRB_GLFW3_CONST("KEY_4", GLFW_KEY_4),
+  MRB_GLFW3_CONST("KEY_5", GLFW_KEY_5),
+  MRB_GLFW3_CONST("KEY_6", GLFW_KEY_6),
+  MRB_GLFW3_CONST("KEY_7", GLFW_KEY_7),
+  MRB_GLFW3_CONST("KEY_8", GLFW_KEY_8),
+  MRB_GLFW3_CONST("KEY_9", GLFW_KEY_9),
+  MRB_GLFW3_CONST("KEY_SEMICOLON", GLFW_KEY_SEMICOLON),
+  MRB_GLFW3_CONST("KEY_EQUAL", GLFW_KEY_EQUAL),
+  MRB_GLFW3_CONST("KEY_A", GLFW_KEY_A),
+  MRB_GLFW3_CONST("KEY_B", GLFW_KEY_B),
+  MRB_GLFW3_CONST("KEY_C", GLFW_KEY_C),
+  MRB_GLFW3_CONST("KEY_D", GLFW_KEY_D),
+  MRB_GLFW3_CONST("KEY_E", GLFW_KEY_E),
+  MRB_GLFW3_CONST("KEY_F", GLFW_KEY_F),
+  MRB_GLFW3_CONST("KEY_G", GLFW_KEY_G),
+  MRB_GLFW3_CONST("KEY_H", GLFW_KEY_H),
+  MRB_GLFW3_CONST("KEY_I", GLFW_KEY_I),
+  MRB_GLFW3_CONST("KEY_J", GLFW_KEY_J),
+  MRB_GLFW3_CONST("KEY_K", GLFW_KEY_K),
+  MRB_GLFW3_CONST("KEY_L", GLFW_KEY_L),
+  MRB_GLFW3_CONST("KEY_M", GLFW_KEY_M),
+  MRB_GLFW3_CONST("KEY_N", GLFW_KEY_N),
+  MRB_GLFW3_CONST("KEY_O", GLFW_KEY_O),
+  MRB_GLFW3_CONST("KEY_P", GLFW_KEY_P),
+  MRB_GLFW3_CONST("KEY_Q", GLFW_KEY_Q),
+  MRB_GLFW3_CONST("KEY_R", GLFW_KEY_R),
+  MRB_GLFW3_CONST("KEY_S", GLFW_KEY_S),
+  MRB_GLFW3_CONST("KEY_T", GLFW_KEY_T),
+  MRB_GLFW3_CONST("KEY_U", GLFW_KEY_U),
+  MRB_GLFW3_CONST("KEY_V", GLFW_KEY_V),
+  MRB_GLFW3_CONST("KEY_W", GLFW_KEY_W),
+  MRB_GLFW3_CONST("KEY_X", GLFW_KEY_X),
+  MRB_GLFW3_CONST("KEY_Y", GLFW_KEY_Y),
+  MRB_GLFW3_CONST("KEY_Z", GLFW_KEY_Z),
+  MRB_GLFW3_CONST("KEY_LEFT_BRACKET", GLFW_KEY_LEFT_BRACKET),
+  MRB_GLFW3_CONST("KEY_BACKSLASH", GLFW_KEY_BACKSLASH),
+  MRB_GLFW3_CONST("KEY_RIGHT_BRACKET", GLFW_KEY_RIGHT_BRACKET),
+  MRB_GLFW3_CONST("KEY_GRAVE_ACCENT", GLFW_KEY_GRAVE_ACCENT),
+  MRB_GLFW3_CONST("KEY_WORLD_1", GLFW_KEY_WORLD_1),
+  MRB_GLFW3_CONST("KEY_WORLD_2", GLFW_KEY_WORLD_2),
+  MRB_GLFW3_CONST("KEY_ESCAPE", GLFW_KEY_ESCAPE),
+  MRB_GLFW3_CONST("KEY_ENTER", GLFW_KEY_ENTER),
+  MRB_GLFW3_CONST("KEY_TAB", GLFW_KEY_TAB),
+  MRB_GLFW3_CONST("KEY_BACKSPACE", GLFW_KEY_BACKSPACE),
+  MRB_GLFW3_CONST("KEY_INSERT", GLFW_KEY_INSERT),
+  MRB_GLFW3_CONST("KEY_DELETE", GLFW_KEY_DELETE),
+  MRB_GLFW3_CONST("KEY_RIGHT", GLFW_KEY_RIGHT),
+  MRB_GLFW3_CONST("KEY_LEFT", GLFW_KEY_LEFT),
+  MRB_GLFW3_CONST("KEY_DOWN", GLFW_KEY_DOWN),
+  MRB_GLFW3_CONST("KEY_UP", GLFW_KEY_UP),
+  MRB_GLFW3_CONST("KEY_PAGE_UP", GLFW_KEY_PAGE_UP),
+  MRB_GLFW3_CONST("KEY_PAGE_DOWN", GLFW_KEY_PAGE_DOWN),
+  MRB_GLFW3_CONST("KEY_HOME", GLFW_KEY_HOME),
+  MRB_GLFW3_CONST("KEY_END", GLFW_KEY_END),
+  MRB_GLFW3_CONST("KEY_CAPS_LOCK", GLFW_KEY_CAPS_LOCK),
+  MRB_GLFW3_CONST("KEY_SCROLL_LOCK", GLFW_KEY_SCROLL_LOCK),
+  MRB_GLFW3_CONST("KEY_NUM_LOCK", GLFW_KEY_NUM_LOCK),
+  MRB_GLFW3_CONST("KEY_PRINT_SCREEN", GLFW_KEY_PRINT_SCREEN),
+  MRB_GLFW3_CONST("KEY_PAUSE", GLFW_KEY_PAUSE),
+  MRB_GLFW3_CONST("KEY_F1", GLFW_KEY_F1),
+  MRB_GLFW3_CONST("KEY_F2", GLFW_KEY_F2),
+  MRB_GLFW3_CONST("KEY_F3", GLFW_KEY_F3),
+  MRB_GLFW3_CONST("KEY_F4", GLFW_KEY_F4),
+  MRB_GLFW3_CONST("KEY_F5", GLFW_KEY_F5),
+  MRB_GLFW3_CONST("KEY_F6", GLFW_KEY_F6),
+  MRB_GLFW3_CONST("KEY_F7", GLFW_KEY_F7),
+  MRB_GLFW3_CONST("KEY_F8", GLFW_KEY_F8),
+  MRB_GLFW3_CONST("KEY_F9", GLFW_KEY_F9),
+  MRB_GLFW3_CONST("KEY_F10", GLFW_KEY_F10),
+  MRB_GLFW3_CONST("KEY_F11", GLFW_KEY_F11),
+  MRB_GLFW3_CONST("KEY_F12", GLFW_KEY_F12),
+  MRB_GLFW3_CONST("KEY_F13", GLFW_KEY_F13),
+  MRB_GLFW3_CONST("KEY_F14", GLFW_KEY_F14),
+  MRB_GLFW3_CONST("KEY_F15", GLFW_KEY_F15),
+  MRB_GLFW3_CONST("KEY_F16", GLFW_KEY_F16),
+  MRB_GLFW3_CONST("KEY_F17", GLFW_KEY_F17),
+  MRB_GLFW3_CONST("KEY_F18", GLFW_KEY_F18),
+  MRB_GLFW3_CONST("KEY_F19", GLFW_KEY_F19),
+  MRB_GLFW3_CONST("KEY_F20", GLFW_KEY_F20),
+  MRB_GLFW3_CONST("KEY_F21", GLFW_KEY_F21),
+  MRB_GLFW3_CONST("KEY_F22", GLFW_KEY_F22),
+  MRB_GLFW3_CONST("KEY_F23", GLFW_KEY_F23),
+  MRB_GLFW3_CONST("KEY_F24", GLFW_KEY_F24),
+  MRB_GLFW3_CONST("KEY_F25", GLFW_KEY_F25),
+  MRB_GLFW3_CONST("KEY_KP_0", GLFW_KEY_KP_0),
+  MRB_GLFW3_CONST("KEY_KP_1", GLFW_KEY_KP_1),
+  MRB_GLFW3_CONST("KEY_KP_2", GLFW_KEY_KP_2),
+  MRB_GLFW3_CONST("KEY_KP_3", GLFW_KEY_KP_3),
+  MRB_GLFW3_CONST("KEY_KP_4", GLFW_KEY_KP_4),
+  MRB_GLFW3_CONST("KEY_KP_5", GLFW_KEY_KP_5),
+  MRB_GLFW3_CONST("KEY_KP_6", GLFW_KEY_KP_6),
+  MRB_GLFW3_CONST("KEY_KP_7", GLFW_KEY_KP_7),
+  MRB_GLFW3_CONST("KEY_KP_8", GLFW_KEY_KP_8),
+  MRB_GLFW3_CONST("KEY_KP_9", GLFW_KEY_KP_9),
+  MRB_GLFW3_CONST("KEY_KP_DECIMAL", GLFW_KEY_KP_DECIMAL),
+  MRB_GLFW3_CONST("KEY_KP_DIVIDE", GLFW_KEY_KP_DIVIDE),
+  MRB_GLFW3_CONST("KEY_KP_MULTIPLY", GLFW_KEY_KP_MULTIPLY),
+  MRB_GLFW3_CONST("KEY_KP_SUBTRACT", GLFW_KEY_KP_SUBTRACT),
+  MRB_GLFW3_CONST("KEY_KP_ADD", GLFW_KEY_KP_ADD),
+  MRB_GLFW3_CONST("KEY_KP_ENTER", GLFW_KEY_KP_ENTER),
+  MRB_GLFW3_CONST("KEY_KP_EQUAL", GLFW_KEY_KP_EQUAL),
+  MRB_GLFW3_CONST("KEY_LEFT_SHIFT", GLFW_KEY_LEFT_SHIFT),
+  MRB_GLFW3_CONST("KEY_LEFT_CONTROL", GLFW_KEY_LEFT_CONTROL),
+  MRB_GLFW3_CONST("KEY_LEFT_ALT", GLFW_KEY_LEFT_ALT),
+  MRB_GLFW3_CONST("KEY_LEFT_SUPER", GLFW_KEY_LEFT_SUPER),
+  MRB_GLFW3_CONST("KEY_RIGHT_SHIFT", GLFW_KEY_RIGHT_SHIFT),
+  MRB_GLFW3_CONST("KEY_RIGHT_CONTROL", GLFW_KEY_RIGHT_CONTROL),
+  MRB_GLFW3_CONST("KEY_RIGHT_ALT", GLFW_KEY_RIGHT_ALT),
+  MRB_GLFW3_CONST("KEY_RIGHT_SUPER", GLFW_KEY_RIGHT_SUPER),
+  MRB_GLFW3_CONST("KEY_MENU", GLFW_KEY_MENU),
+  MRB_GLFW3_CONST("KEY_LAST", GLFW_KEY_LAST),
+  MRB_GLFW3_CONST("MOD_SHIFT", GLFW_MOD_SHIFT),
+  MRB_GLFW3_CONST("MOD_CONTROL", GLFW_MOD_CONTROL),
+  MRB_GLFW3_CONST("MOD_ALT", GLFW_MOD_ALT),
+  MRB_GLFW3_CONST("MOD_SUPER", GLFW_MOD_SUPER),
+  MRB_GLFW3_CONST("MOUSE_BUTTON_1", GLFW_MOUSE_BUTTON_1),
+  MRB_GLFW3_CONST("MOUSE_BUTTON_2", GLFW_MOUSE_BUTTON_2),
+  MRB_GLFW3_CONST("MOUSE_BUTTON_3", GLFW_MOUSE_BUTTON_3),
+  MRB_GLFW3_CONST("MOUSE_BUTTON_4", GLFW_MOUSE_BUTTON_4),
+  MRB_GLFW3_CONST("MOUSE_BUTTON_5", GLFW_MOUSE_BUTTON_5),
+  MRB_GLFW3_CONST("MOUSE_BUTTON_6", GLFW_MOUSE_BUTTON_6),
+  MRB_GLFW3_CONST("MOUSE_BUTTON_7", GLFW_MOUSE_BUTTON_7),
+  MRB_GLFW3_CONST("MOUSE_BUTTON_8", GLFW_MOUSE_BUTTON_8),
+  MRB_GLFW3_CONST("MOUSE_BUTTON_LAST", GLFW_MOUSE_BUTTON_LAST),
+  MRB_GLFW3_CONST("MOUSE_BUTTON_LEFT", GLFW_MOUSE_BUTTON_LEFT),
+  MRB_GLFW3_CONST("MOUSE_BUTTON_RIGHT", GLFW_MOUSE_BUTTON_RIGHT),
+  MRB_GLFW3_CONST("MOUSE_BUTTON_MIDDLE", GLFW_MOUSE_BUTTON_MIDDLE),
+  MRB_GLFW3_CONST("JOYSTICK_1", GLFW_JOYSTICK_1),
+  MRB_GLFW3_CONST("JOYSTICK_2", GLFW_JOYSTICK_2),
+  MRB_GLFW3_CONST("JOYSTICK_3", GLFW_JOYSTICK_3),
+  MRB_GLFW3_CONST("JOYSTICK_4", GLFW_JOYSTICK_4),
+  MRB_GLFW3_CONST("JOYSTICK_5", GLFW_JOYSTICK_5),
+  MRB_GLFW3_CONST("JOYSTICK_6", GLFW_JOYSTICK_6),
+  MRB_GLFW3_CONST("JOYSTICK_7", GLFW_JOYSTICK_7),
+  MRB_GLFW3_CONST("JOYSTICK_8", GLFW_JOYSTICK_8),
+  MRB_GLFW3_CONST("JOYSTICK_9", GLFW_JOYSTICK_9),
+  MRB_GLFW3_CONST("JOYSTICK_10", GLFW_JOYSTICK_10),
+  MRB_GLFW3_CONST("JOYSTICK_11", GLFW_JOYSTICK_11),
+  MRB_GLFW3_CONST("JOYSTICK_12", GLFW_JOYSTICK_12),
+  MRB_GLFW3_CONST("JOYSTICK_13", GLFW_JOYSTICK_13),
+  MRB_GLFW3_CONST("JOYSTICK_14", GLFW_JOYSTICK_14),
+  MRB_GLFW3_CONST("JOYSTICK_15", GLFW_JOYSTICK_15),
+  MRB_GLFW3_CONST("JOYSTICK_16", GLFW_JOYSTICK_16),
+  MRB_GLFW3_CONST("JOYSTICK_LAST", GLFW_JOYSTICK_LAST),
+  MRB_GLFW3_CONST("NOT_INITIALIZED", GLFW_NOT_INITIALIZED),
+  MRB_GLFW3_CONST("NO_CURRENT_CONTEXT", GLFW_NO_CURRENT_CONTEXT),
+  MRB_GLFW3_CONST("INVALID_ENUM", GLFW_INVALID_ENUM),
+  MRB_GLFW3_CONST("INVALID_VALUE", GLFW_INVALID_VALUE),
+  MRB_GLFW3_CONST("OUT_OF_MEMORY", GLFW_OUT_OF_MEMORY),
+  MRB_GLFW3_CONST("API_UNAVAILABLE", GLFW_API_UNAVAILABLE),
+  MRB_GLFW3_CONST("VERSION_UNAVAILABLE", GLFW_VERSION_UNAVAILABLE),
+  MRB_GLFW3_CONST("PLATFORM_ERROR", GLFW_PLATFORM_ERROR),
+  MRB_GLFW3_CONST("FORMAT_UNAVAILABLE", GLFW_FORMAT_UNAVAILABLE),
+  MRB_GLFW3_CONST("FOCUSED", GLFW_FOCUSED),
+  MRB_GLFW3_CONST("ICONIFIED", GLFW_ICONIFIED),
+  MRB_GLFW3_CONST("RESIZABLE", GLFW_RESIZABLE),
+  MRB_GLFW3_CONST("VISIBLE", GLFW_VISIBLE),
+  MRB_GLFW3_CONST("DECORATED", GLFW_DECORATED),
+  MRB_GLFW3_CONST("AUTO_ICONIFY", GLFW_AUTO_ICONIFY),
+  MRB_GLFW3_CONST("FLOATING", GLFW_FLOATING),
+  MRB_GLFW3_CONST("RED_BITS", GLFW_RED_BITS),
+  MRB_GLFW3_CONST("GREEN_BITS", GLFW_GREEN_BITS),
+  MRB_GLFW3_CONST("BLUE_BITS", GLFW_BLUE_BITS),
+  MRB_GLFW3_CONST("ALPHA_BITS", GLFW_ALPHA_BITS),
+  MRB_GLFW3_CONST("DEPTH_BITS", GLFW_DEPTH_BITS),
+  MRB_GLFW3_CONST("STENCIL_BITS", GLFW_STENCIL_BITS),
+  MRB_GLFW3_CONST("ACCUM_RED_BITS", GLFW_ACCUM_RED_BITS),
+  MRB_GLFW3_CONST("ACCUM_GREEN_BITS", GLFW_ACCUM_GREEN_BITS),
+  MRB_GLFW3_CONST("ACCUM_BLUE_BITS", GLFW_ACCUM_BLUE_BITS),
+  MRB_GLFW3_CONST("ACCUM_ALPHA_BITS", GLFW_ACCUM_ALPHA_BITS),
+  MRB_GLFW3_CONST("AUX_BUFFERS", GLFW_AUX_BUFFERS),
+  MRB_GLFW3_CONST("STEREO", GLFW_STEREO),
+  MRB_GLFW3_CONST("SAMPLES", GLFW_SAMPLES),
+  MRB_GLFW3_CONST("SRGB_CAPABLE", GLFW_SRGB_CAPABLE),
+  MRB_GLFW3_CONST("REFRESH_RATE", GLFW_REFRESH_RATE),
+  MRB_GLFW3_CONST("DOUBLEBUFFER", GLFW_DOUBLEBUFFER),
+  MRB_GLFW3_CONST("CLIENT_API", GLFW_CLIENT_API),
+  MRB_GLFW3_CONST("CONTEXT_VERSION_MAJOR", GLFW_CONTEXT_VERSION_MAJOR),
+  MRB_GLFW3_CONST("CONTEXT_VERSION_MINOR", GLFW_CONTEXT_VERSION_MINOR),
+  MRB_GLFW3_CONST("CONTEXT_REVISION", GLFW_CONTEXT_REVISION),
+  MRB_GLFW3_CONST("CONTEXT_ROBUSTNESS", GLFW_CONTEXT_ROBUSTNESS),
+  MRB_GLFW3_CONST("OPENGL_FORWARD_COMPAT", GLFW_OPENGL_FORWARD_COMPAT),
+  MRB_GLFW3_CONST("OPENGL_DEBUG_CONTEXT", GLFW_OPENGL_DEBUG_CONTEXT),
+  MRB_GLFW3_CONST("OPENGL_PROFILE", GLFW_OPENGL_PROFILE),
+  MRB_GLFW3_CONST("CONTEXT_RELEASE_BEHAVIOR", GLFW_CONTEXT_RELEASE_BEHAVIOR),
+  MRB_GLFW3_CONST("OPENGL_API", GLFW_OPENGL_API),
+  MRB_GLFW3_CONST("OPENGL_ES_API", GLFW_OPENGL_ES_API),
+  MRB_GLFW3_CONST("NO_ROBUSTNESS", GLFW_NO_ROBUSTNESS),
+  MRB_GLFW3_CONST("NO_RESET_NOTIFICATION", GLFW_NO_RESET_NOTIFICATION),
+  MRB_GLFW3_CONST("LOSE_CONTEXT_ON_RESET", GLFW_LOSE_CONTEXT_ON_RESET),
+  MRB_GLFW3_CONST("OPENGL_ANY_PROFILE", GLFW_OPENGL_ANY_PROFILE),
+  MRB_GLFW3_CONST("OPENGL_CORE_PROFILE", GLFW_OPENGL_CORE_PROFILE),
+  MRB_GLFW3_CONST("OPENGL_COMPAT_PROFILE", GLFW_OPENGL_COMPAT_PROFILE),
+  MRB_GLFW3_CONST("CURSOR", GLFW_CURSOR),
+  MRB_GLFW3_CONST("STICKY_KEYS", GLFW_STICKY_KEYS),
+  MRB_GLFW3_CONST("STICKY_MOUSE_BUTTONS", GLFW_STICKY_MOUSE_BUTTONS),
+  MRB_GLFW3_CONST("CURSOR_NORMAL", GLFW_CURSOR_NORMAL),
+  MRB_GLFW3_CONST("CURSOR_HIDDEN", GLFW_CURSOR_HIDDEN),
+  MRB_GLFW3_CONST("CURSOR_DISABLED", GLFW_CURSOR_DISABLED),
+  MRB_GLFW3_CONST("ANY_RELEASE_BEHAVIOR", GLFW_ANY_RELEASE_BEHAVIOR),
+  MRB_GLFW3_CONST("RELEASE_BEHAVIOR_FLUSH", GLFW_RELEASE_BEHAVIOR_FLUSH),
+  MRB_GLFW3_CONST("RELEASE_BEHAVIOR_NONE", GLFW_RELEASE_BEHAVIOR_NONE),
+  MRB_GLFW3_CONST("ARROW_CURSOR", GLFW_ARROW_CURSOR),
+  MRB_GLFW3_CONST("IBEAM_CURSOR", GLFW_IBEAM_CURSOR),
+  MRB_GLFW3_CONST("CROSSHAIR_CURSOR", GLFW_CROSSHAIR_CURSOR),
+  MRB_GLFW3_CONST("HAND_CURSOR", GLFW_HAND_CURSOR),
+  MRB_GLFW3_CONST("HRESIZE_CURSOR", GLFW_HRESIZE_CURSOR),
+  MRB_GLFW3_CONST("VRESIZE_CURSOR", GLFW_VRESIZE_CURSOR),
+  MRB_GLFW3_CONST("CONNECTED", GLFW_CONNECTED),
+  MRB_GLFW3_CONST("DISCONNECTED", GLFW_DISCONNECTED),
+  MRB_GLFW3_CONST("DONT_CARE", GLFW_DONT_CARE),
+  MRB_GLFW3_CONST("NO_API", GLFW_NO_API),
+  MRB_GLFW3_CONST("CONTEXT_CREATION_API", GLFW_CONTEXT_CREATION_API),
+  MRB_GLFW3_CONST("NATIVE_CONTEXT_API", GLFW_NATIVE_CONTEXT_API),
+  MRB_GLFW3_CONST("EGL_CONTEXT_API", GLFW_EGL_CONTEXT_API),
+#if MRB_GLFW3_VERSION_AT_LEAST(3, 3)
+  MRB_GLFW3_CONST("OSMESA_CONTEXT_API", GLFW_OSMESA_CONTEXT_API),
+#endif
+#if MRB_GLFW3_VERSION_AT_LEAST(3, 4)
+  MRB_GLFW3_CONST("PLATFORM", GLFW_PLATFORM),
+  MRB_GLFW3_CONST("ANY_PLATFORM", GLFW_ANY_PLATFORM),
+  MRB_GLFW3_CONST("PLATFORM_NULL", GLFW_PLATFORM_NULL),
+  MRB_GLFW3_CONST("PLATFORM_X11", GLFW_PLATFORM_X11),
+  MRB_GLFW3_CONST("PLATFORM_WAYLAND", GLFW_PLATFORM_WAYLAND),
+  MRB_GLFW3_CONST("PLATFORM_WIN32", GLFW_PLATFORM_WIN32),
+  MRB_GLFW3_CONST("PLATFORM_COCOA", GLFW_PLATFORM_COCOA),
+#endif
+};
+
 void
 mrb_mruby_glfw3_gem_init(mrb_state* mrb)
 {
   struct RClass *glfw_module;
   /* Setup error callbacks */
   glfw_mrb_state = mrb;
+  glfw_joysticks.callback = mrb_nil_value();
   glfwSetErrorCallback(&glfw_error_func);
   mrb_define_class(mrb, "GLFWError", mrb_class_get(mrb, "StandardError"));
   /* GLFW module */
   glfw_module = mrb_define_module(mrb, "GLFW");
   /* Cache */
   mrb_iv_set(mrb, mrb_obj_value(glfw_module), mrb_intern_lit(mrb, "__glfw_objects"), mrb_ary_new(mrb));
+  mrb_iv_set(mrb, mrb_obj_value(glfw_module), mrb_intern_lit(mrb, "__glfw_windows"), mrb_hash_new(mrb));
   /* module methods */
-  mrb_define_class_method(mrb, glfw_module, "init",                 glfw_init,                  MRB_ARGS_NONE());
+  mrb_define_class_method(mrb, glfw_module, "init",                 glfw_init,                  MRB_ARGS_OPT(1));
+  mrb_define_class_method(mrb, glfw_module, "initialized?",         glfw_initialized_p,         MRB_ARGS_NONE());
+  mrb_define_class_method(mrb, glfw_module, "init_hint",            glfw_init_hint,             MRB_ARGS_REQ(2));
+  mrb_define_class_method(mrb, glfw_module, "platform_supported?",  glfw_platform_supported_p,  MRB_ARGS_REQ(1));
+  mrb_define_class_method(mrb, glfw_module, "headless?",            glfw_headless_p,            MRB_ARGS_NONE());
   mrb_define_class_method(mrb, glfw_module, "terminate",            glfw_terminate,             MRB_ARGS_NONE());
   mrb_define_class_method(mrb, glfw_module, "version",              glfw_version,               MRB_ARGS_NONE());
   mrb_define_class_method(mrb, glfw_module, "version_string",       glfw_version_string,        MRB_ARGS_NONE());
@@ -291,7 +767,6 @@ mrb_mruby_glfw3_gem_init(mrb_state* mrb)
   mrb_define_class_method(mrb, glfw_module, "time=",                glfw_set_time,              MRB_ARGS_REQ(1));
   mrb_define_class_method(mrb, glfw_module, "current_context",      glfw_current_context,       MRB_ARGS_NONE());
   mrb_define_class_method(mrb, glfw_module, "swap_interval=",       glfw_set_swap_interval,     MRB_ARGS_REQ(1));
-  mrb_define_class_method(mrb, glfw_module, "extension_supported?", glfw_extension_supported_p, MRB_ARGS_REQ(1));
   mrb_define_class_method(mrb, glfw_module, "proc_address",         glfw_proc_address,          MRB_ARGS_REQ(1));
   /* Joystick */
   mrb_define_class_method(mrb, glfw_module, "joystick_present",     glfw_joystick_present,      MRB_ARGS_REQ(1));
@@ -299,249 +774,31 @@ mrb_mruby_glfw3_gem_init(mrb_state* mrb)
   mrb_define_class_method(mrb, glfw_module, "joystick_buttons",     glfw_joystick_buttons,      MRB_ARGS_REQ(1));
   mrb_define_class_method(mrb, glfw_module, "joystick_name",        glfw_joystick_name,         MRB_ARGS_REQ(1));
   mrb_define_class_method(mrb, glfw_module, "set_joystick_callback", glfw_set_joystick_callback, MRB_ARGS_ARG(0,1) | MRB_ARGS_BLOCK());
+  mrb_define_class_method(mrb, glfw_module, "connected_joysticks",  glfw_connected_joysticks,   MRB_ARGS_NONE());
   /* internal cache */
   mrb_define_class_method(mrb, glfw_module, "cache_size", glfw_cache_size, MRB_ARGS_NONE());
   /* Constants */
-  mrb_define_const(mrb, glfw_module, "VERSION_MAJOR", mrb_fixnum_value(GLFW_VERSION_MAJOR));
-  mrb_define_const(mrb, glfw_module, "VERSION_MINOR", mrb_fixnum_value(GLFW_VERSION_MINOR));
-  mrb_define_const(mrb, glfw_module, "VERSION_REVISION", mrb_fixnum_value(GLFW_VERSION_REVISION));
-  mrb_define_const(mrb, glfw_module, "RELEASE", mrb_fixnum_value(GLFW_RELEASE));
-  mrb_define_const(mrb, glfw_module, "PRESS", mrb_fixnum_value(GLFW_PRESS));
-  mrb_define_const(mrb, glfw_module, "REPEAT", mrb_fixnum_value(GLFW_REPEAT));
-  mrb_define_const(mrb, glfw_module, "KEY_UNKNOWN", mrb_fixnum_value(GLFW_KEY_UNKNOWN));
-  mrb_define_const(mrb, glfw_module, "KEY_SPACE", mrb_fixnum_value(GLFW_KEY_SPACE));
-  mrb_define_const(mrb, glfw_module, "KEY_APOSTROPHE", mrb_fixnum_value(GLFW_KEY_APOSTROPHE));
-  mrb_define_const(mrb, glfw_module, "KEY_COMMA", mrb_fixnum_value(GLFW_KEY_COMMA));
-  mrb_define_const(mrb, glfw_module, "KEY_MINUS", mrb_fixnum_value(GLFW_KEY_MINUS));
-  mrb_define_const(mrb, glfw_module, "KEY_PERIOD", mrb_fixnum_value(GLFW_KEY_PERIOD));
-  mrb_define_const(mrb, glfw_module, "KEY_SLASH", mrb_fixnum_value(GLFW_KEY_SLASH));
-  mrb_define_const(mrb, glfw_module, "KEY_0", mrb_fixnum_value(GLFW_KEY_0));
-  mrb_define_const(mrb, glfw_module, "KEY_1", mrb_fixnum_value(GLFW_KEY_1));
-  mrb_define_const(mrb, glfw_module, "KEY_2", mrb_fixnum_value(GLFW_KEY_2));
-  mrb_define_const(mrb, glfw_module, "KEY_3", mrb_fixnum_value(GLFW_KEY_3));
-  mrb_define_const(mrb, glfw_module, "KEY_4", mrb_fixnum_value(GLFW_KEY_4));
-  mrb_define_const(mrb, glfw_module, "KEY_5", mrb_fixnum_value(GLFW_KEY_5));
-  mrb_define_const(mrb, glfw_module, "KEY_6", mrb_fixnum_value(GLFW_KEY_6));
-  mrb_define_const(mrb, glfw_module, "KEY_7", mrb_fixnum_value(GLFW_KEY_7));
-  mrb_define_const(mrb, glfw_module, "KEY_8", mrb_fixnum_value(GLFW_KEY_8));
-  mrb_define_const(mrb, glfw_module, "KEY_9", mrb_fixnum_value(GLFW_KEY_9));
-  mrb_define_const(mrb, glfw_module, "KEY_SEMICOLON", mrb_fixnum_value(GLFW_KEY_SEMICOLON));
-  mrb_define_const(mrb, glfw_module, "KEY_EQUAL", mrb_fixnum_value(GLFW_KEY_EQUAL));
-  mrb_define_const(mrb, glfw_module, "KEY_A", mrb_fixnum_value(GLFW_KEY_A));
-  mrb_define_const(mrb, glfw_module, "KEY_B", mrb_fixnum_value(GLFW_KEY_B));
-  mrb_define_const(mrb, glfw_module, "KEY_C", mrb_fixnum_value(GLFW_KEY_C));
-  mrb_define_const(mrb, glfw_module, "KEY_D", mrb_fixnum_value(GLFW_KEY_D));
-  mrb_define_const(mrb, glfw_module, "KEY_E", mrb_fixnum_value(GLFW_KEY_E));
-  mrb_define_const(mrb, glfw_module, "KEY_F", mrb_fixnum_value(GLFW_KEY_F));
-  mrb_define_const(mrb, glfw_module, "KEY_G", mrb_fixnum_value(GLFW_KEY_G));
-  mrb_define_const(mrb, glfw_module, "KEY_H", mrb_fixnum_value(GLFW_KEY_H));
-  mrb_define_const(mrb, glfw_module, "KEY_I", mrb_fixnum_value(GLFW_KEY_I));
-  mrb_define_const(mrb, glfw_module, "KEY_J", mrb_fixnum_value(GLFW_KEY_J));
-  mrb_define_const(mrb, glfw_module, "KEY_K", mrb_fixnum_value(GLFW_KEY_K));
-  mrb_define_const(mrb, glfw_module, "KEY_L", mrb_fixnum_value(GLFW_KEY_L));
-  mrb_define_const(mrb, glfw_module, "KEY_M", mrb_fixnum_value(GLFW_KEY_M));
-  mrb_define_const(mrb, glfw_module, "KEY_N", mrb_fixnum_value(GLFW_KEY_N));
-  mrb_define_const(mrb, glfw_module, "KEY_O", mrb_fixnum_value(GLFW_KEY_O));
-  mrb_define_const(mrb, glfw_module, "KEY_P", mrb_fixnum_value(GLFW_KEY_P));
-  mrb_define_const(mrb, glfw_module, "KEY_Q", mrb_fixnum_value(GLFW_KEY_Q));
-  mrb_define_const(mrb, glfw_module, "KEY_R", mrb_fixnum_value(GLFW_KEY_R));
-  mrb_define_const(mrb, glfw_module, "KEY_S", mrb_fixnum_value(GLFW_KEY_S));
-  mrb_define_const(mrb, glfw_module, "KEY_T", mrb_fixnum_value(GLFW_KEY_T));
-  mrb_define_const(mrb, glfw_module, "KEY_U", mrb_fixnum_value(GLFW_KEY_U));
-  mrb_define_const(mrb, glfw_module, "KEY_V", mrb_fixnum_value(GLFW_KEY_V));
-  mrb_define_const(mrb, glfw_module, "KEY_W", mrb_fixnum_value(GLFW_KEY_W));
-  mrb_define_const(mrb, glfw_module, "KEY_X", mrb_fixnum_value(GLFW_KEY_X));
-  mrb_define_const(mrb, glfw_module, "KEY_Y", mrb_fixnum_value(GLFW_KEY_Y));
-  mrb_define_const(mrb, glfw_module, "KEY_Z", mrb_fixnum_value(GLFW_KEY_Z));
-  mrb_define_const(mrb, glfw_module, "KEY_LEFT_BRACKET", mrb_fixnum_value(GLFW_KEY_LEFT_BRACKET));
-  mrb_define_const(mrb, glfw_module, "KEY_BACKSLASH", mrb_fixnum_value(GLFW_KEY_BACKSLASH));
-  mrb_define_const(mrb, glfw_module, "KEY_RIGHT_BRACKET", mrb_fixnum_value(GLFW_KEY_RIGHT_BRACKET));
-  mrb_define_const(mrb, glfw_module, "KEY_GRAVE_ACCENT", mrb_fixnum_value(GLFW_KEY_GRAVE_ACCENT));
-  mrb_define_const(mrb, glfw_module, "KEY_WORLD_1", mrb_fixnum_value(GLFW_KEY_WORLD_1));
-  mrb_define_const(mrb, glfw_module, "KEY_WORLD_2", mrb_fixnum_value(GLFW_KEY_WORLD_2));
-  mrb_define_const(mrb, glfw_module, "KEY_ESCAPE", mrb_fixnum_value(GLFW_KEY_ESCAPE));
-  mrb_define_const(mrb, glfw_module, "KEY_ENTER", mrb_fixnum_value(GLFW_KEY_ENTER));
-  mrb_define_const(mrb, glfw_module, "KEY_TAB", mrb_fixnum_value(GLFW_KEY_TAB));
-  mrb_define_const(mrb, glfw_module, "KEY_BACKSPACE", mrb_fixnum_value(GLFW_KEY_BACKSPACE));
-  mrb_define_const(mrb, glfw_module, "KEY_INSERT", mrb_fixnum_value(GLFW_KEY_INSERT));
-  mrb_define_const(mrb, glfw_module, "KEY_DELETE", mrb_fixnum_value(GLFW_KEY_DELETE));
-  mrb_define_const(mrb, glfw_module, "KEY_RIGHT", mrb_fixnum_value(GLFW_KEY_RIGHT));
-  mrb_define_const(mrb, glfw_module, "KEY_LEFT", mrb_fixnum_value(GLFW_KEY_LEFT));
-  mrb_define_const(mrb, glfw_module, "KEY_DOWN", mrb_fixnum_value(GLFW_KEY_DOWN));
-  mrb_define_const(mrb, glfw_module, "KEY_UP", mrb_fixnum_value(GLFW_KEY_UP));
-  mrb_define_const(mrb, glfw_module, "KEY_PAGE_UP", mrb_fixnum_value(GLFW_KEY_PAGE_UP));
-  mrb_define_const(mrb, glfw_module, "KEY_PAGE_DOWN", mrb_fixnum_value(GLFW_KEY_PAGE_DOWN));
-  mrb_define_const(mrb, glfw_module, "KEY_HOME", mrb_fixnum_value(GLFW_KEY_HOME));
-  mrb_define_const(mrb, glfw_module, "KEY_END", mrb_fixnum_value(GLFW_KEY_END));
-  mrb_define_const(mrb, glfw_module, "KEY_CAPS_LOCK", mrb_fixnum_value(GLFW_KEY_CAPS_LOCK));
-  mrb_define_const(mrb, glfw_module, "KEY_SCROLL_LOCK", mrb_fixnum_value(GLFW_KEY_SCROLL_LOCK));
-  mrb_define_const(mrb, glfw_module, "KEY_NUM_LOCK", mrb_fixnum_value(GLFW_KEY_NUM_LOCK));
-  mrb_define_const(mrb, glfw_module, "KEY_PRINT_SCREEN", mrb_fixnum_value(GLFW_KEY_PRINT_SCREEN));
-  mrb_define_const(mrb, glfw_module, "KEY_PAUSE", mrb_fixnum_value(GLFW_KEY_PAUSE));
-  mrb_define_const(mrb, glfw_module, "KEY_F1", mrb_fixnum_value(GLFW_KEY_F1));
-  mrb_define_const(mrb, glfw_module, "KEY_F2", mrb_fixnum_value(GLFW_KEY_F2));
-  mrb_define_const(mrb, glfw_module, "KEY_F3", mrb_fixnum_value(GLFW_KEY_F3));
-  mrb_define_const(mrb, glfw_module, "KEY_F4", mrb_fixnum_value(GLFW_KEY_F4));
-  mrb_define_const(mrb, glfw_module, "KEY_F5", mrb_fixnum_value(GLFW_KEY_F5));
-  mrb_define_const(mrb, glfw_module, "KEY_F6", mrb_fixnum_value(GLFW_KEY_F6));
-  mrb_define_const(mrb, glfw_module, "KEY_F7", mrb_fixnum_value(GLFW_KEY_F7));
-  mrb_define_const(mrb, glfw_module, "KEY_F8", mrb_fixnum_value(GLFW_KEY_F8));
-  mrb_define_const(mrb, glfw_module, "KEY_F9", mrb_fixnum_value(GLFW_KEY_F9));
-  mrb_define_const(mrb, glfw_module, "KEY_F10", mrb_fixnum_value(GLFW_KEY_F10));
-  mrb_define_const(mrb, glfw_module, "KEY_F11", mrb_fixnum_value(GLFW_KEY_F11));
-  mrb_define_const(mrb, glfw_module, "KEY_F12", mrb_fixnum_value(GLFW_KEY_F12));
-  mrb_define_const(mrb, glfw_module, "KEY_F13", mrb_fixnum_value(GLFW_KEY_F13));
-  mrb_define_const(mrb, glfw_module, "KEY_F14", mrb_fixnum_value(GLFW_KEY_F14));
-  mrb_define_const(mrb, glfw_module, "KEY_F15", mrb_fixnum_value(GLFW_KEY_F15));
-  mrb_define_const(mrb, glfw_module, "KEY_F16", mrb_fixnum_value(GLFW_KEY_F16));
-  mrb_define_const(mrb, glfw_module, "KEY_F17", mrb_fixnum_value(GLFW_KEY_F17));
-  mrb_define_const(mrb, glfw_module, "KEY_F18", mrb_fixnum_value(GLFW_KEY_F18));
-  mrb_define_const(mrb, glfw_module, "KEY_F19", mrb_fixnum_value(GLFW_KEY_F19));
-  mrb_define_const(mrb, glfw_module, "KEY_F20", mrb_fixnum_value(GLFW_KEY_F20));
-  mrb_define_const(mrb, glfw_module, "KEY_F21", mrb_fixnum_value(GLFW_KEY_F21));
-  mrb_define_const(mrb, glfw_module, "KEY_F22", mrb_fixnum_value(GLFW_KEY_F22));
-  mrb_define_const(mrb, glfw_module, "KEY_F23", mrb_fixnum_value(GLFW_KEY_F23));
-  mrb_define_const(mrb, glfw_module, "KEY_F24", mrb_fixnum_value(GLFW_KEY_F24));
-  mrb_define_const(mrb, glfw_module, "KEY_F25", mrb_fixnum_value(GLFW_KEY_F25));
-  mrb_define_const(mrb, glfw_module, "KEY_KP_0", mrb_fixnum_value(GLFW_KEY_KP_0));
-  mrb_define_const(mrb, glfw_module, "KEY_KP_1", mrb_fixnum_value(GLFW_KEY_KP_1));
-  mrb_define_const(mrb, glfw_module, "KEY_KP_2", mrb_fixnum_value(GLFW_KEY_KP_2));
-  mrb_define_const(mrb, glfw_module, "KEY_KP_3", mrb_fixnum_value(GLFW_KEY_KP_3));
-  mrb_define_const(mrb, glfw_module, "KEY_KP_4", mrb_fixnum_value(GLFW_KEY_KP_4));
-  mrb_define_const(mrb, glfw_module, "KEY_KP_5", mrb_fixnum_value(GLFW_KEY_KP_5));
-  mrb_define_const(mrb, glfw_module, "KEY_KP_6", mrb_fixnum_value(GLFW_KEY_KP_6));
-  mrb_define_const(mrb, glfw_module, "KEY_KP_7", mrb_fixnum_value(GLFW_KEY_KP_7));
-  mrb_define_const(mrb, glfw_module, "KEY_KP_8", mrb_fixnum_value(GLFW_KEY_KP_8));
-  mrb_define_const(mrb, glfw_module, "KEY_KP_9", mrb_fixnum_value(GLFW_KEY_KP_9));
-  mrb_define_const(mrb, glfw_module, "KEY_KP_DECIMAL", mrb_fixnum_value(GLFW_KEY_KP_DECIMAL));
-  mrb_define_const(mrb, glfw_module, "KEY_KP_DIVIDE", mrb_fixnum_value(GLFW_KEY_KP_DIVIDE));
-  mrb_define_const(mrb, glfw_module, "KEY_KP_MULTIPLY", mrb_fixnum_value(GLFW_KEY_KP_MULTIPLY));
-  mrb_define_const(mrb, glfw_module, "KEY_KP_SUBTRACT", mrb_fixnum_value(GLFW_KEY_KP_SUBTRACT));
-  mrb_define_const(mrb, glfw_module, "KEY_KP_ADD", mrb_fixnum_value(GLFW_KEY_KP_ADD));
-  mrb_define_const(mrb, glfw_module, "KEY_KP_ENTER", mrb_fixnum_value(GLFW_KEY_KP_ENTER));
-  mrb_define_const(mrb, glfw_module, "KEY_KP_EQUAL", mrb_fixnum_value(GLFW_KEY_KP_EQUAL));
-  mrb_define_const(mrb, glfw_module, "KEY_LEFT_SHIFT", mrb_fixnum_value(GLFW_KEY_LEFT_SHIFT));
-  mrb_define_const(mrb, glfw_module, "KEY_LEFT_CONTROL", mrb_fixnum_value(GLFW_KEY_LEFT_CONTROL));
-  mrb_define_const(mrb, glfw_module, "KEY_LEFT_ALT", mrb_fixnum_value(GLFW_KEY_LEFT_ALT));
-  mrb_define_const(mrb, glfw_module, "KEY_LEFT_SUPER", mrb_fixnum_value(GLFW_KEY_LEFT_SUPER));
-  mrb_define_const(mrb, glfw_module, "KEY_RIGHT_SHIFT", mrb_fixnum_value(GLFW_KEY_RIGHT_SHIFT));
-  mrb_define_const(mrb, glfw_module, "KEY_RIGHT_CONTROL", mrb_fixnum_value(GLFW_KEY_RIGHT_CONTROL));
-  mrb_define_const(mrb, glfw_module, "KEY_RIGHT_ALT", mrb_fixnum_value(GLFW_KEY_RIGHT_ALT));
-  mrb_define_const(mrb, glfw_module, "KEY_RIGHT_SUPER", mrb_fixnum_value(GLFW_KEY_RIGHT_SUPER));
-  mrb_define_const(mrb, glfw_module, "KEY_MENU", mrb_fixnum_value(GLFW_KEY_MENU));
-  mrb_define_const(mrb, glfw_module, "KEY_LAST", mrb_fixnum_value(GLFW_KEY_LAST));
-  mrb_define_const(mrb, glfw_module, "MOD_SHIFT", mrb_fixnum_value(GLFW_MOD_SHIFT));
-  mrb_define_const(mrb, glfw_module, "MOD_CONTROL", mrb_fixnum_value(GLFW_MOD_CONTROL));
-  mrb_define_const(mrb, glfw_module, "MOD_ALT", mrb_fixnum_value(GLFW_MOD_ALT));
-  mrb_define_const(mrb, glfw_module, "MOD_SUPER", mrb_fixnum_value(GLFW_MOD_SUPER));
-  mrb_define_const(mrb, glfw_module, "MOUSE_BUTTON_1", mrb_fixnum_value(GLFW_MOUSE_BUTTON_1));
-  mrb_define_const(mrb, glfw_module, "MOUSE_BUTTON_2", mrb_fixnum_value(GLFW_MOUSE_BUTTON_2));
-  mrb_define_const(mrb, glfw_module, "MOUSE_BUTTON_3", mrb_fixnum_value(GLFW_MOUSE_BUTTON_3));
-  mrb_define_const(mrb, glfw_module, "MOUSE_BUTTON_4", mrb_fixnum_value(GLFW_MOUSE_BUTTON_4));
-  mrb_define_const(mrb, glfw_module, "MOUSE_BUTTON_5", mrb_fixnum_value(GLFW_MOUSE_BUTTON_5));
-  mrb_define_const(mrb, glfw_module, "MOUSE_BUTTON_6", mrb_fixnum_value(GLFW_MOUSE_BUTTON_6));
-  mrb_define_const(mrb, glfw_module, "MOUSE_BUTTON_7", mrb_fixnum_value(GLFW_MOUSE_BUTTON_7));
-  mrb_define_const(mrb, glfw_module, "MOUSE_BUTTON_8", mrb_fixnum_value(GLFW_MOUSE_BUTTON_8));
-  mrb_define_const(mrb, glfw_module, "MOUSE_BUTTON_LAST", mrb_fixnum_value(GLFW_MOUSE_BUTTON_LAST));
-  mrb_define_const(mrb, glfw_module, "MOUSE_BUTTON_LEFT", mrb_fixnum_value(GLFW_MOUSE_BUTTON_LEFT));
-  mrb_define_const(mrb, glfw_module, "MOUSE_BUTTON_RIGHT", mrb_fixnum_value(GLFW_MOUSE_BUTTON_RIGHT));
-  mrb_define_const(mrb, glfw_module, "MOUSE_BUTTON_MIDDLE", mrb_fixnum_value(GLFW_MOUSE_BUTTON_MIDDLE));
-  mrb_define_const(mrb, glfw_module, "JOYSTICK_1", mrb_fixnum_value(GLFW_JOYSTICK_1));
-  mrb_define_const(mrb, glfw_module, "JOYSTICK_2", mrb_fixnum_value(GLFW_JOYSTICK_2));
-  mrb_define_const(mrb, glfw_module, "JOYSTICK_3", mrb_fixnum_value(GLFW_JOYSTICK_3));
-  mrb_define_const(mrb, glfw_module, "JOYSTICK_4", mrb_fixnum_value(GLFW_JOYSTICK_4));
-  mrb_define_const(mrb, glfw_module, "JOYSTICK_5", mrb_fixnum_value(GLFW_JOYSTICK_5));
-  mrb_define_const(mrb, glfw_module, "JOYSTICK_6", mrb_fixnum_value(GLFW_JOYSTICK_6));
-  mrb_define_const(mrb, glfw_module, "JOYSTICK_7", mrb_fixnum_value(GLFW_JOYSTICK_7));
-  mrb_define_const(mrb, glfw_module, "JOYSTICK_8", mrb_fixnum_value(GLFW_JOYSTICK_8));
-  mrb_define_const(mrb, glfw_module, "JOYSTICK_9", mrb_fixnum_value(GLFW_JOYSTICK_9));
-  mrb_define_const(mrb, glfw_module, "JOYSTICK_10", mrb_fixnum_value(GLFW_JOYSTICK_10));
-  mrb_define_const(mrb, glfw_module, "JOYSTICK_11", mrb_fixnum_value(GLFW_JOYSTICK_11));
-  mrb_define_const(mrb, glfw_module, "JOYSTICK_12", mrb_fixnum_value(GLFW_JOYSTICK_12));
-  mrb_define_const(mrb, glfw_module, "JOYSTICK_13", mrb_fixnum_value(GLFW_JOYSTICK_13));
-  mrb_define_const(mrb, glfw_module, "JOYSTICK_14", mrb_fixnum_value(GLFW_JOYSTICK_14));
-  mrb_define_const(mrb, glfw_module, "JOYSTICK_15", mrb_fixnum_value(GLFW_JOYSTICK_15));
-  mrb_define_const(mrb, glfw_module, "JOYSTICK_16", mrb_fixnum_value(GLFW_JOYSTICK_16));
-  mrb_define_const(mrb, glfw_module, "JOYSTICK_LAST", mrb_fixnum_value(GLFW_JOYSTICK_LAST));
-  mrb_define_const(mrb, glfw_module, "NOT_INITIALIZED", mrb_fixnum_value(GLFW_NOT_INITIALIZED));
-  mrb_define_const(mrb, glfw_module, "NO_CURRENT_CONTEXT", mrb_fixnum_value(GLFW_NO_CURRENT_CONTEXT));
-  mrb_define_const(mrb, glfw_module, "INVALID_ENUM", mrb_fixnum_value(GLFW_INVALID_ENUM));
-  mrb_define_const(mrb, glfw_module, "INVALID_VALUE", mrb_fixnum_value(GLFW_INVALID_VALUE));
-  mrb_define_const(mrb, glfw_module, "OUT_OF_MEMORY", mrb_fixnum_value(GLFW_OUT_OF_MEMORY));
-  mrb_define_const(mrb, glfw_module, "API_UNAVAILABLE", mrb_fixnum_value(GLFW_API_UNAVAILABLE));
-  mrb_define_const(mrb, glfw_module, "VERSION_UNAVAILABLE", mrb_fixnum_value(GLFW_VERSION_UNAVAILABLE));
-  mrb_define_const(mrb, glfw_module, "PLATFORM_ERROR", mrb_fixnum_value(GLFW_PLATFORM_ERROR));
-  mrb_define_const(mrb, glfw_module, "FORMAT_UNAVAILABLE", mrb_fixnum_value(GLFW_FORMAT_UNAVAILABLE));
-  mrb_define_const(mrb, glfw_module, "FOCUSED", mrb_fixnum_value(GLFW_FOCUSED));
-  mrb_define_const(mrb, glfw_module, "ICONIFIED", mrb_fixnum_value(GLFW_ICONIFIED));
-  mrb_define_const(mrb, glfw_module, "RESIZABLE", mrb_fixnum_value(GLFW_RESIZABLE));
-  mrb_define_const(mrb, glfw_module, "VISIBLE", mrb_fixnum_value(GLFW_VISIBLE));
-  mrb_define_const(mrb, glfw_module, "DECORATED", mrb_fixnum_value(GLFW_DECORATED));
-  mrb_define_const(mrb, glfw_module, "AUTO_ICONIFY", mrb_fixnum_value(GLFW_AUTO_ICONIFY));
-  mrb_define_const(mrb, glfw_module, "FLOATING", mrb_fixnum_value(GLFW_FLOATING));
-  mrb_define_const(mrb, glfw_module, "RED_BITS", mrb_fixnum_value(GLFW_RED_BITS));
-  mrb_define_const(mrb, glfw_module, "GREEN_BITS", mrb_fixnum_value(GLFW_GREEN_BITS));
-  mrb_define_const(mrb, glfw_module, "BLUE_BITS", mrb_fixnum_value(GLFW_BLUE_BITS));
-  mrb_define_const(mrb, glfw_module, "ALPHA_BITS", mrb_fixnum_value(GLFW_ALPHA_BITS));
-  mrb_define_const(mrb, glfw_module, "DEPTH_BITS", mrb_fixnum_value(GLFW_DEPTH_BITS));
-  mrb_define_const(mrb, glfw_module, "STENCIL_BITS", mrb_fixnum_value(GLFW_STENCIL_BITS));
-  mrb_define_const(mrb, glfw_module, "ACCUM_RED_BITS", mrb_fixnum_value(GLFW_ACCUM_RED_BITS));
-  mrb_define_const(mrb, glfw_module, "ACCUM_GREEN_BITS", mrb_fixnum_value(GLFW_ACCUM_GREEN_BITS));
-  mrb_define_const(mrb, glfw_module, "ACCUM_BLUE_BITS", mrb_fixnum_value(GLFW_ACCUM_BLUE_BITS));
-  mrb_define_const(mrb, glfw_module, "ACCUM_ALPHA_BITS", mrb_fixnum_value(GLFW_ACCUM_ALPHA_BITS));
-  mrb_define_const(mrb, glfw_module, "AUX_BUFFERS", mrb_fixnum_value(GLFW_AUX_BUFFERS));
-  mrb_define_const(mrb, glfw_module, "STEREO", mrb_fixnum_value(GLFW_STEREO));
-  mrb_define_const(mrb, glfw_module, "SAMPLES", mrb_fixnum_value(GLFW_SAMPLES));
-  mrb_define_const(mrb, glfw_module, "SRGB_CAPABLE", mrb_fixnum_value(GLFW_SRGB_CAPABLE));
-  mrb_define_const(mrb, glfw_module, "REFRESH_RATE", mrb_fixnum_value(GLFW_REFRESH_RATE));
-  mrb_define_const(mrb, glfw_module, "DOUBLEBUFFER", mrb_fixnum_value(GLFW_DOUBLEBUFFER));
-  mrb_define_const(mrb, glfw_module, "CLIENT_API", mrb_fixnum_value(GLFW_CLIENT_API));
-  mrb_define_const(mrb, glfw_module, "CONTEXT_VERSION_MAJOR", mrb_fixnum_value(GLFW_CONTEXT_VERSION_MAJOR));
-  mrb_define_const(mrb, glfw_module, "CONTEXT_VERSION_MINOR", mrb_fixnum_value(GLFW_CONTEXT_VERSION_MINOR));
-  mrb_define_const(mrb, glfw_module, "CONTEXT_REVISION", mrb_fixnum_value(GLFW_CONTEXT_REVISION));
-  mrb_define_const(mrb, glfw_module, "CONTEXT_ROBUSTNESS", mrb_fixnum_value(GLFW_CONTEXT_ROBUSTNESS));
-  mrb_define_const(mrb, glfw_module, "OPENGL_FORWARD_COMPAT", mrb_fixnum_value(GLFW_OPENGL_FORWARD_COMPAT));
-  mrb_define_const(mrb, glfw_module, "OPENGL_DEBUG_CONTEXT", mrb_fixnum_value(GLFW_OPENGL_DEBUG_CONTEXT));
-  mrb_define_const(mrb, glfw_module, "OPENGL_PROFILE", mrb_fixnum_value(GLFW_OPENGL_PROFILE));
-  mrb_define_const(mrb, glfw_module, "CONTEXT_RELEASE_BEHAVIOR", mrb_fixnum_value(GLFW_CONTEXT_RELEASE_BEHAVIOR));
-  mrb_define_const(mrb, glfw_module, "OPENGL_API", mrb_fixnum_value(GLFW_OPENGL_API));
-  mrb_define_const(mrb, glfw_module, "OPENGL_ES_API", mrb_fixnum_value(GLFW_OPENGL_ES_API));
-  mrb_define_const(mrb, glfw_module, "NO_ROBUSTNESS", mrb_fixnum_value(GLFW_NO_ROBUSTNESS));
-  mrb_define_const(mrb, glfw_module, "NO_RESET_NOTIFICATION", mrb_fixnum_value(GLFW_NO_RESET_NOTIFICATION));
-  mrb_define_const(mrb, glfw_module, "LOSE_CONTEXT_ON_RESET", mrb_fixnum_value(GLFW_LOSE_CONTEXT_ON_RESET));
-  mrb_define_const(mrb, glfw_module, "OPENGL_ANY_PROFILE", mrb_fixnum_value(GLFW_OPENGL_ANY_PROFILE));
-  mrb_define_const(mrb, glfw_module, "OPENGL_CORE_PROFILE", mrb_fixnum_value(GLFW_OPENGL_CORE_PROFILE));
-  mrb_define_const(mrb, glfw_module, "OPENGL_COMPAT_PROFILE", mrb_fixnum_value(GLFW_OPENGL_COMPAT_PROFILE));
-  mrb_define_const(mrb, glfw_module, "CURSOR", mrb_fixnum_value(GLFW_CURSOR));
-  mrb_define_const(mrb, glfw_module, "STICKY_KEYS", mrb_fixnum_value(GLFW_STICKY_KEYS));
-  mrb_define_const(mrb, glfw_module, "STICKY_MOUSE_BUTTONS", mrb_fixnum_value(GLFW_STICKY_MOUSE_BUTTONS));
-  mrb_define_const(mrb, glfw_module, "CURSOR_NORMAL", mrb_fixnum_value(GLFW_CURSOR_NORMAL));
-  mrb_define_const(mrb, glfw_module, "CURSOR_HIDDEN", mrb_fixnum_value(GLFW_CURSOR_HIDDEN));
-  mrb_define_const(mrb, glfw_module, "CURSOR_DISABLED", mrb_fixnum_value(GLFW_CURSOR_DISABLED));
-  mrb_define_const(mrb, glfw_module, "ANY_RELEASE_BEHAVIOR", mrb_fixnum_value(GLFW_ANY_RELEASE_BEHAVIOR));
-  mrb_define_const(mrb, glfw_module, "RELEASE_BEHAVIOR_FLUSH", mrb_fixnum_value(GLFW_RELEASE_BEHAVIOR_FLUSH));
-  mrb_define_const(mrb, glfw_module, "RELEASE_BEHAVIOR_NONE", mrb_fixnum_value(GLFW_RELEASE_BEHAVIOR_NONE));
-  mrb_define_const(mrb, glfw_module, "ARROW_CURSOR", mrb_fixnum_value(GLFW_ARROW_CURSOR));
-  mrb_define_const(mrb, glfw_module, "IBEAM_CURSOR", mrb_fixnum_value(GLFW_IBEAM_CURSOR));
-  mrb_define_const(mrb, glfw_module, "CROSSHAIR_CURSOR", mrb_fixnum_value(GLFW_CROSSHAIR_CURSOR));
-  mrb_define_const(mrb, glfw_module, "HAND_CURSOR", mrb_fixnum_value(GLFW_HAND_CURSOR));
-  mrb_define_const(mrb, glfw_module, "HRESIZE_CURSOR", mrb_fixnum_value(GLFW_HRESIZE_CURSOR));
-  mrb_define_const(mrb, glfw_module, "VRESIZE_CURSOR", mrb_fixnum_value(GLFW_VRESIZE_CURSOR));
-  mrb_define_const(mrb, glfw_module, "CONNECTED", mrb_fixnum_value(GLFW_CONNECTED));
-  mrb_define_const(mrb, glfw_module, "DISCONNECTED", mrb_fixnum_value(GLFW_DISCONNECTED));
-  mrb_define_const(mrb, glfw_module, "DONT_CARE", mrb_fixnum_value(GLFW_DONT_CARE));
+  mrb_glfw3_define_consts(mrb, glfw_module, glfw_constants, MRB_GLFW3_CONST_COUNT(glfw_constants));
   /* sub-modules */
   mrb_glfw3_vid_mode_init(mrb, glfw_module);
   mrb_glfw3_gamma_ramp_init(mrb, glfw_module);
   mrb_glfw3_image_init(mrb, glfw_module);
+  mrb_glfw3_hint_set_init(mrb, glfw_module);
   mrb_glfw3_cursor_init(mrb, glfw_module);
+  mrb_glfw3_input_map_init(mrb, glfw_module);
+  mrb_glfw3_drop_list_init(mrb, glfw_module);
   mrb_glfw3_monitor_init(mrb, glfw_module);
   mrb_glfw3_window_init(mrb, glfw_module);
+  mrb_glfw3_proc_table_init(mrb, glfw_module);
+  mrb_glfw3_readback_init(mrb, glfw_module);
+  mrb_glfw3_extensions_init(mrb, glfw_module);
 }
 
 void
 mrb_mruby_glfw3_gem_final(mrb_state* mrb)
 {
   glfw_terminate_m(mrb);
+  mrb_glfw3_vid_mode_final(mrb);
+  glfw_joysticks.callback = mrb_nil_value();
   glfw_mrb_state = NULL;
 }
@@ -0,0 +1,18 @@
+assert('GLFW::GammaRamp type') do
+  assert_kind_of(Class, GLFW::GammaRamp)
+end
+
+assert('GLFW::GammaRamp#get_row') do
+  ramp = GLFW::GammaRamp.new(4)
+  assert_equal([0, 0, 0], ramp.get_row(3))
+  assert_raise(IndexError) { ramp.get_row(4) }
+end
+
+assert('GLFW::GammaRamp#set_row') do
+  ramp = GLFW::GammaRamp.new(4)
+  ramp.set_row(0, 1, 2, 3)
+  ramp.set_row(3, 65535, 0, 256)
+  assert_equal([1, 2, 3], ramp.get_row(0))
+  assert_equal([65535, 0, 256], ramp.get_row(3))
+  assert_raise(IndexError) { ramp.set_row(4, 0, 0, 0) }
+end
@@ -0,0 +1,420 @@
+assert('GLFW::ProcTable type') do
+  assert_kind_of(Class, GLFW::ProcTable)
+end
+
+assert('GLFW.track_extensions') do
+  ids = GLFW.track_extensions(['GL_ARB_debug_output', 'GL_ARB_vertex_array_object'])
+  assert_equal({ GL_ARB_debug_output: 0, GL_ARB_vertex_array_object: 1 }, ids)
+  GLFW.track_extensions([])
+end
+
+assert('GLFW.headless?') do
+  assert_false(GLFW.headless?)
+end
+
+# Windows are created without a context unless a test asks for one, so the
+# null platform does not need OSMesa. Without the null platform (GLFW < 3.4)
+# hidden windows on the native platform are used when a display is present.
+headless = if GLFW.platform_supported?(:null)
+             GLFW.init(platform: :null, client_api: :none)
+           else
+             begin
+               GLFW.init(headless: true, client_api: :none)
+             rescue GLFWError => e
+               puts "Skipping the window tests: no null platform and #{e.message}"
+               false
+             end
+           end
+
+# @return [GLFW::Window, nil] a hidden window with an OpenGL context, nil
+#   where none can be created
+def headless_gl_window(title)
+  GLFW::Window.new(32, 32, title, hints: GLFW::HintSet.new(GLFW::CLIENT_API => GLFW::OPENGL_API))
+rescue GLFWError
+  nil
+end
+
+if headless
+  assert('GLFW.init (headless)') do
+    assert_true(GLFW.headless?)
+  end
+
+  assert('GLFW.init client_api:') do
+    window = GLFW::Window.new(32, 32, 'No context test')
+    assert_equal(GLFW::NO_API, window.window_attrib(GLFW::CLIENT_API))
+    window.destroy
+  end
+
+  assert('GLFW::Window (headless)') do
+    window = GLFW::Window.new(320, 240, 'Headless test')
+    assert_kind_of(GLFW::Window, window)
+    window.window_size = [640, 480]
+    GLFW.poll_events
+    assert_equal([640, 480], window.window_size)
+    assert_false(window.should_close?)
+    window.destroy
+    true
+  end
+
+  assert('GLFW::Window#inject_key') do
+    window = GLFW::Window.new(320, 240, 'Inject test')
+    keys = []
+    window.set_key_callback { |w, key, scancode, action, mods| keys << [key, action, mods] }
+    window.inject_key(GLFW::KEY_A, 0, GLFW::PRESS, GLFW::MOD_SHIFT)
+    window.inject_scroll(1, 2) # no callback set
+    window.destroy
+    assert_equal([[GLFW::KEY_A, GLFW::PRESS, GLFW::MOD_SHIFT]], keys)
+  end
+
+  assert('GLFW::Window#inject_events') do
+    window = GLFW::Window.new(320, 240, 'Inject events test')
+    positions = []
+    drops = nil
+    window.set_cursor_pos_callback { |w, x, y| positions << [x, y] }
+    window.set_drop_callback { |w, paths| drops = paths }
+    events = GLFW::Window.pack_event(GLFW::Window::EVENT_CURSOR_POS, 1.5, 2.5) +
+             GLFW::Window.pack_event(GLFW::Window::EVENT_CURSOR_POS, 3.0, 4.0)
+    window.inject_events(events)
+    window.inject_drop(['a.png', 'b.png'])
+    window.destroy
+    assert_equal([[1.5, 2.5], [3.0, 4.0]], positions)
+    assert_kind_of(GLFW::DropList, drops)
+    assert_equal(['a.png', 'b.png'], drops.to_a)
+  end
+
+  assert('GLFW::DropList') do
+    window = GLFW::Window.new(320, 240, 'Drop list test')
+    list = nil
+    window.set_drop_callback { |w, paths| list = paths }
+    window.inject_drop(['a.PNG', 'b.txt', 'c.png', 'png'])
+    window.destroy
+    assert_equal(4, list.size)
+    assert_equal('png', list[-1])
+    assert_nil(list[4])
+    assert_equal(['a.PNG', 'c.png'], list.filter_extensions('.png').to_a)
+    assert_equal(['a.PNG', 'b.txt', 'c.png'], list.filter_extensions('png', 'txt').to_a)
+  end
+
+  assert('GLFW::Window#take_text_input') do
+    window = GLFW::Window.new(320, 240, 'Text input test')
+    assert_false(window.text_input?)
+    window.text_input = true
+    assert_nil(window.take_text_input)
+    [0x68, 0xE9, 0x20AC, 0x1F600].each { |cp| window.inject_char(cp) }
+    text = window.take_text_input
+    assert_equal("h\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80", text)
+    assert_nil(window.take_text_input)
+    window.destroy
+  end
+
+  assert('GLFW::Window.new with hints') do
+    hints = GLFW::HintSet.new(GLFW::RESIZABLE => 0)
+    a = GLFW::Window.new(320, 240, 'Hints test A', hints: hints)
+    b = GLFW::Window.new(320, 240, 'Hints test B', nil, nil, hints: hints)
+    assert_equal(0, a.window_attrib(GLFW::RESIZABLE))
+    assert_equal(0, b.window_attrib(GLFW::RESIZABLE))
+    c = GLFW::Window.new(320, 240, 'Hints test C')
+    assert_equal(1, c.window_attrib(GLFW::RESIZABLE))
+    assert_raise(TypeError) { GLFW::Window.new(320, 240, 'Bad hints', hints: { GLFW::RESIZABLE => 0 }) }
+    assert_raise(TypeError) { GLFW::Window.new(320, 240, 'Bad monitor', 1) }
+    assert_raise(TypeError) { GLFW::Window.new(320, 240, 'Bad share', nil, 1) }
+    a.destroy
+    b.destroy
+    c.destroy
+  end
+
+  assert('GLFW::WindowPool') do
+    pool = GLFW::WindowPool.new(1)
+    a = pool.acquire(320, 240, 'Pool A')
+    a.set_key_callback { |*args| raise 'should have been cleared' }
+    pool.release(a)
+    assert_equal(1, pool.size)
+    b = pool.acquire(640, 480, 'Pool B')
+    assert_equal(a, b)
+    assert_equal([640, 480], b.window_size)
+    b.inject_key(GLFW::KEY_A, 0, GLFW::PRESS, 0)
+    c = pool.acquire(320, 240, 'Pool C')
+    pool.release(b)
+    pool.release(c)
+    assert_true(c.destroyed?)
+    pool.clear
+    assert_true(b.destroyed?)
+    pool = GLFW::WindowPool.new(2)
+    a = pool.acquire(320, 240, 'Pool A')
+    pool.release(a)
+    pool.release(a)
+    assert_equal(1, pool.size)
+    assert_false(a.destroyed?)
+    foreign = GLFW::Window.new(320, 240, 'Pool foreign')
+    pool.release(foreign)
+    assert_equal(1, pool.size)
+    b = pool.acquire(320, 240, 'Pool B')
+    c = pool.acquire(320, 240, 'Pool C')
+    assert_not_equal(b, c)
+    foreign.destroy
+    b.destroy
+    c.destroy
+    pool.clear
+  end
+
+  assert('GLFW.each_event') do
+    a = GLFW::Window.new(320, 240, 'Queue A')
+    b = GLFW::Window.new(320, 240, 'Queue B')
+    assert_not_equal(a.id, b.id)
+    a.set_key_callback { |*args| raise 'should have been queued' }
+    GLFW.event_queue = true
+    assert_true(GLFW.event_queue?)
+    a.inject_key(GLFW::KEY_A, 0, GLFW::PRESS, 0)
+    b.inject_cursor_pos(1.5, 2.5)
+    a.inject_char(0x41)
+    events = []
+    assert_equal(3, GLFW.each_event { |*ev| events << ev })
+    assert_equal([a, GLFW::Window::EVENT_KEY, GLFW::KEY_A, 0, GLFW::PRESS, 0], events[0])
+    assert_equal([b, GLFW::Window::EVENT_CURSOR_POS, 1.5, 2.5], events[1])
+    assert_equal([a, GLFW::Window::EVENT_CHAR, 0x41], events[2])
+    b.inject_scroll(0.0, 1.0)
+    b.destroy
+    assert_equal(0, GLFW.each_event { |*ev| raise 'destroyed window' })
+    c = GLFW::Window.new(320, 240, 'Queue C')
+    c.inject_focus(1)
+    c.inject_focus(0)
+    a.inject_iconify(1)
+    events = []
+    assert_equal(2, GLFW.each_event { |w, *ev| events << [w, *ev]; w.destroy if w == c })
+    assert_equal([[c, GLFW::Window::EVENT_FOCUS, 1], [a, GLFW::Window::EVENT_ICONIFY, 1]], events)
+    a.inject_focus(1)
+    assert_equal(GLFW::Window.pack_event(GLFW::Window::EVENT_FOCUS, 1).size, GLFW.take_events.size)
+    GLFW.event_queue = false
+    assert_false(GLFW.event_queue?)
+    a.destroy
+  end
+
+  assert('GLFW.windows_state') do
+    a = GLFW::Window.new(320, 240, 'State A')
+    b = GLFW::Window.new(160, 120, 'State B')
+    b.should_close = 1
+    state = GLFW.windows_state
+    assert_equal(2 * GLFW::WINDOW_STATE_STRIDE, state.size)
+    assert_equal([a, false], state[0, 2])
+    assert_equal([b, true], state[GLFW::WINDOW_STATE_STRIDE, 2])
+    assert_equal(b.framebuffer_size, state[-2, 2])
+    b.destroy
+    assert_equal(GLFW::WINDOW_STATE_STRIDE, GLFW.windows_state.size)
+    a.destroy
+  end
+
+  assert('GLFW::Cursor sharing') do
+    count = GLFW::Cursor.handle_count
+    image = GLFW::Image.new(16, 16)
+    a = GLFW::Cursor.create(image, 0, 0)
+    b = GLFW::Cursor.create(GLFW::Image.new(16, 16), 0, 0)
+    assert_equal(count + 1, GLFW::Cursor.handle_count)
+    c = GLFW::Cursor.create(image, 1, 1)
+    assert_equal(count + 2, GLFW::Cursor.handle_count)
+    hands = [GLFW::Cursor.create_standard(GLFW::HAND_CURSOR),
+             GLFW::Cursor.create_standard(GLFW::HAND_CURSOR)]
+    assert_equal(count + 3, GLFW::Cursor.handle_count)
+    assert_raise(GLFWError) { GLFW::Cursor.create_standard(0) }
+    assert_equal(count + 3, GLFW::Cursor.handle_count)
+    window = GLFW::Window.new(320, 240, 'Cursor test')
+    window.set_cursor(b)
+    window.set_cursor(hands[1])
+    window.destroy
+  end
+
+  assert('GLFW::Window#icon=') do
+    window = GLFW::Window.new(320, 240, 'Icon test')
+    icons = GLFW::Image.new(64, 64).icon_set
+    assert_equal(icons, window.icon = icons)
+    window.icon = icons[0]
+    window.icon = nil
+    assert_raise(TypeError) { window.icon = [1] }
+    window.destroy
+  end
+
+  assert('GLFW::Window#read_framebuffer') do
+    window = GLFW::Window.new(32, 32, 'Readback test')
+    assert_raise(TypeError) { window.read_framebuffer(nil) }
+    assert_raise(GLFWError) { window.read_framebuffer(GLFW::Image.new(32, 32)) }
+    window.destroy
+  end
+
+  assert('GLFW::VidModeList') do
+    GLFW.monitors.each do |monitor|
+      modes = monitor.vid_modes
+      assert_kind_of(GLFW::VidModeList, modes)
+      assert_true(modes.valid?)
+      assert_equal(modes.size, monitor.vid_modes.size)
+      modes.each { |mode| assert_kind_of(GLFW::VidMode, mode) }
+      assert_nil(modes[modes.size])
+    end
+  end
+
+  assert('GLFW.monitor_layout') do
+    layout = GLFW.monitor_layout
+    assert_kind_of(Hash, layout)
+    assert_equal(GLFW.monitors.size, layout[:monitors].size)
+    [:x, :y, :width, :height, :refresh_rate, :width_mm, :height_mm, :dpi_x, :dpi_y].each do |key|
+      assert_equal(layout[:monitors].size, layout[key].size)
+    end
+    assert_equal(layout.object_id, GLFW.monitor_layout.object_id)
+    assert_true(layout.frozen?)
+    assert_true(layout[:monitors].frozen?)
+    lists = GLFW.monitors.map(&:vid_modes)
+    window = GLFW::Window.new(320, 240, 'Layout test')
+    window.set_monitor(nil, 0, 0, 320, 240)
+    assert_not_equal(layout.object_id, GLFW.monitor_layout.object_id)
+    lists.each do |modes|
+      assert_true(modes.valid?)
+      assert_kind_of(GLFW::VidMode, modes[0]) if modes.size > 0
+    end
+    window.destroy
+  end
+
+  assert('GLFW.initialized?') do
+    assert_true(GLFW.initialized?)
+  end
+
+  assert('GLFW::Window callback arity') do
+    window = GLFW::Window.new(320, 240, 'Callback arity test')
+    got = []
+    window.set_cursor_pos_callback { |w, x| got << x }
+    window.inject_cursor_pos(1.5, 2.5)
+    window.set_key_callback { |*args| got << args.size }
+    window.inject_key(GLFW::KEY_A, 0, GLFW::PRESS, 0)
+    window.set_focus_callback(&lambda { |w| got << w })
+    window.inject_focus(1)
+    window.set_key_callback
+    window.inject_key(GLFW::KEY_A, 0, GLFW::PRESS, 0)
+    window.clear_callbacks
+    window.inject_cursor_pos(0, 0)
+    window.destroy
+    assert_equal([1.5, 5, window], got)
+  end
+
+  assert('GLFW::Window#input_map=') do
+    window = GLFW::Window.new(320, 240, 'Input map test')
+    map = GLFW::InputMap.new(2)
+    map.bind_key(GLFW::KEY_SPACE, 0)
+    map.bind_mouse_button(GLFW::MOUSE_BUTTON_LEFT, 1)
+    window.input_map = map
+    window.inject_key(GLFW::KEY_SPACE, 0, GLFW::PRESS, 0)
+    assert_equal([GLFW::InputMap::DOWN | GLFW::InputMap::PRESSED, 0], map.update)
+    assert_equal([GLFW::InputMap::DOWN, 0], map.update)
+    window.inject_key(GLFW::KEY_SPACE, 0, GLFW::RELEASE, 0)
+    window.inject_mouse_button(GLFW::MOUSE_BUTTON_LEFT, GLFW::PRESS, 0)
+    window.inject_mouse_button(GLFW::MOUSE_BUTTON_LEFT, GLFW::RELEASE, 0)
+    tap = GLFW::InputMap::PRESSED | GLFW::InputMap::RELEASED
+    assert_equal([GLFW::InputMap::RELEASED, tap], map.update)
+    assert_equal([0, 0], map.update)
+    window.inject_key(GLFW::KEY_SPACE, 0, GLFW::PRESS, 0)
+    window.inject_key(GLFW::KEY_SPACE, 0, GLFW::RELEASE, 0)
+    assert_equal([tap, 0], map.update)
+    assert_raise(TypeError) { window.input_map = 1 }
+    window.clear_callbacks
+    window.inject_key(GLFW::KEY_SPACE, 0, GLFW::PRESS, 0)
+    assert_equal([0, 0], map.update)
+    window.input_map = map
+    window.input_map = nil
+    window.destroy
+    assert_equal([0, 0], map.update)
+  end
+
+  assert('GLFW.connected_joysticks') do
+    mask = GLFW.connected_joysticks
+    assert_kind_of(Integer, mask)
+    (GLFW::JOYSTICK_1..GLFW::JOYSTICK_LAST).each do |id|
+      assert_equal((mask >> id) & 1 == 1, GLFW.joystick_present?(id))
+    end
+    assert_equal(GLFW.joysticks.size, GLFW.joysticks.count(&:present?))
+  end
+
+  assert('GLFW::Window#take_cursor_history') do
+    window = GLFW::Window.new(320, 240, 'Cursor history test')
+    assert_equal([], window.take_cursor_history)
+    window.cursor_history = 2
+    window.inject_cursor_pos(1.0, 2.0)
+    window.inject_cursor_pos(3.0, 4.0)
+    window.inject_cursor_pos(5.0, 6.0)
+    samples = window.take_cursor_history
+    window.inject_cursor_pos(7.0, 8.0)
+    window.clear_callbacks
+    assert_equal(0, window.cursor_history)
+    assert_equal([], window.take_cursor_history)
+    window.destroy
+    assert_equal(2 * GLFW::Window::CURSOR_SAMPLE_STRIDE, samples.size)
+    assert_equal([3.0, 4.0, 5.0, 6.0], [samples[1], samples[2], samples[4], samples[5]])
+    assert_true(samples[0] <= samples[3])
+  end
+
+  assert('GLFW::Window destroyed') do
+    window = GLFW::Window.new(320, 240, 'Destroyed test')
+    window.destroy
+    window.destroy
+    assert_true(window.destroyed?)
+    assert_raise(GLFWError) { window.window_size }
+    assert_raise(GLFWError) { window.inject_key(GLFW::KEY_A, 0, GLFW::PRESS, 0) }
+    window.make_current
+    assert_nil(GLFW.current_context)
+  end
+
+  assert('GLFW.load_proc_table') do
+    window = headless_gl_window('Proc table test')
+    if window
+      window.make_current
+      table = GLFW.load_proc_table(['glClear', 'glNotAFunctionAnywhere'])
+      assert_kind_of(GLFW::ProcTable, table)
+      assert_equal(2, table.size)
+      assert_equal(!table[0].nil?, table.loaded?(0))
+      assert_nil(table[1])
+      assert_false(table.loaded?(1))
+      assert_nil(table[2])
+      assert_equal(table.loaded?(0) ? 1 : 2, table.missing_count)
+      assert_equal(table.object_id, window.proc_table.object_id)
+      again = GLFW.load_proc_table(['glClear', 'glNotAFunctionAnywhere'])
+      assert_equal(table.object_id, again.object_id)
+      assert_equal(again.object_id, window.proc_table.object_id)
+      other = GLFW.load_proc_table(['glClear'])
+      assert_not_equal(table.object_id, other.object_id)
+      window.destroy
+    end
+  end
+
+  assert('GLFW.extension_supported?') do
+    a = headless_gl_window('Extensions test A')
+    b = a && headless_gl_window('Extensions test B')
+    if b
+      names = ['GL_ARB_vertex_array_object', 'GL_NOT_AN_EXTENSION']
+      GLFW.track_extensions(names)
+      a.make_current
+      before = names.map { |name| GLFW.extension_supported?(name) }
+      assert_equal(before, [GLFW.extension_supported?(:GL_ARB_vertex_array_object),
+                            GLFW.extension_supported?(:GL_NOT_AN_EXTENSION)])
+      assert_equal(before, [GLFW.extension_supported?(0), GLFW.extension_supported?(1)])
+      assert_false(GLFW.extension_supported?(1))
+      b.make_current
+      assert_equal(names.map { |name| GLFW.extension_supported?(name) },
+                   [GLFW.extension_supported?(0), GLFW.extension_supported?(1)])
+      a.make_current
+      assert_equal(before, [GLFW.extension_supported?(0), GLFW.extension_supported?(1)])
+      assert_raise(ArgumentError) { GLFW.extension_supported?(:GL_UNTRACKED) }
+      GLFW.track_extensions([])
+      b.destroy
+    end
+    a.destroy if a
+  end
+
+  GLFW.terminate
+
+  assert('GLFW.terminate') do
+    assert_false(GLFW.initialized?)
+  end
+end
+
+# GLFW.init options outlive terminate, later test files create windows with
+# a context on the default platform
+begin
+  GLFW.platform_supported?(:null) ? GLFW.init(platform: :any) : GLFW.init(headless: false)
+rescue GLFWError
+end
+GLFW.terminate
@@ -0,0 +1,20 @@
+assert('GLFW::HintSet type') do
+  assert_kind_of(Class, GLFW::HintSet)
+end
+
+assert('GLFW::HintSet#initialize') do
+  set = GLFW::HintSet.new(GLFW::RESIZABLE => 0, GLFW::SAMPLES => 4)
+  assert_equal(2, set.size)
+  assert_equal(4, set[GLFW::SAMPLES])
+  assert_nil(set[GLFW::STEREO])
+end
+
+assert('GLFW::HintSet#[]=') do
+  set = GLFW::HintSet.new
+  set[GLFW::SAMPLES] = 4
+  set[GLFW::SAMPLES] = 8
+  assert_equal(1, set.size)
+  assert_equal(8, set[GLFW::SAMPLES])
+  assert_equal(8, set.delete(GLFW::SAMPLES))
+  assert_equal(0, set.size)
+end
@@ -14,3 +14,60 @@ assert('GLFW::Image#[]') do
   img[0, 0] = [0, 0, 0, 255]
   assert_equal([0, 0, 0, 255], img[0, 0])
 end
+
+assert('GLFW::Image#resize') do
+  img = GLFW::Image.new(4, 2)
+  img[0, 0] = [0, 0, 0, 255]
+  img[1, 0] = [255, 0, 0, 255]
+  img[0, 1] = [0, 255, 0, 255]
+  img[1, 1] = [255, 255, 0, 255]
+  small = img.resize(2, 1)
+  assert_equal(2, small.width)
+  assert_equal(1, small.height)
+  assert_equal([128, 128, 0, 255], small[0, 0])
+  assert_equal([0, 0, 0, 0], small[1, 0])
+  assert_equal(8, img.resize(8, 8).memsize / img.memsize)
+end
+
+assert('GLFW::Image#icon_set') do
+  icons = GLFW::Image.new(512, 512).icon_set
+  assert_equal(GLFW::Image::ICON_SIZES, icons.map(&:width))
+  assert_equal(GLFW::Image::ICON_SIZES, icons.map(&:height))
+end
+
+assert('GLFW::Image#diff') do
+  a = GLFW::Image.new(4, 4)
+  b = GLFW::Image.new(4, 4)
+  count, max, psnr = a.diff(b)
+  assert_equal(0, count)
+  assert_equal(0, max)
+  assert_equal(Float::INFINITY, psnr)
+  b[1, 1] = [10, 0, 0, 0]
+  b[2, 2] = [0, 2, 0, 0]
+  assert_equal(2, a.diff(b)[0])
+  assert_equal(10, a.diff(b)[1])
+  assert_equal(1, a.diff(b, 2)[0])
+  out = GLFW::Image.new(4, 4)
+  a.diff(b, 0, out)
+  assert_equal([10, 0, 0, 0], out[1, 1])
+  assert_raise(ArgumentError) { a.diff(GLFW::Image.new(2, 2)) }
+  assert_raise(ArgumentError) { a.diff(b, -1) }
+end
+
+assert('GLFW::Image#dump and GLFW::Image.load') do
+  path = File.join(File.exist?('/tmp') ? '/tmp' : '.', 'glfw3_image_test.bin')
+  img = GLFW::Image.new(5, 3)
+  img[0, 0] = [1, 2, 3, 4]
+  img[4, 2] = [255, 0, 255, 255]
+  begin
+    [false, true].each do |compress|
+      img.dump(path, compress)
+      loaded = GLFW::Image.load(path)
+      assert_equal([5, 3], [loaded.width, loaded.height])
+      assert_equal(0, img.diff(loaded)[0])
+    end
+  ensure
+    File.delete(path) if File.exist?(path)
+  end
+  assert_raise(RuntimeError) { GLFW::Image.load('glfw3_image_test.missing') }
+end
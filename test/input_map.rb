@@ -0,0 +1,19 @@
+assert('GLFW::InputMap type') do
+  assert_kind_of(Class, GLFW::InputMap)
+end
+
+assert('GLFW::InputMap#bind_key') do
+  map = GLFW::InputMap.new(2)
+  assert_equal(2, map.action_count)
+  map.bind_key(GLFW::KEY_SPACE, 1)
+  map.bind_key(GLFW::KEY_SPACE, nil)
+  assert_raise(ArgumentError) { map.bind_key(GLFW::KEY_SPACE, 2) }
+  assert_raise(ArgumentError) { map.bind_key(-1, 0) }
+  assert_raise(ArgumentError) { map.bind_joystick_axis(GLFW::JOYSTICK_1, 0, 0, 1.5) }
+end
+
+assert('GLFW::InputMap#update') do
+  map = GLFW::InputMap.new(3)
+  assert_equal([0, 0, 0], map.update)
+  assert_equal(0.0, map.value(2))
+end